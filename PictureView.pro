@@ -1,6 +1,9 @@
-QT += core gui widgets concurrent
+QT += core gui widgets concurrent network
 CONFIG += c++17
 
+# Release 构建在编译期去掉 qDebug/qCDebug（参数不求值），警告和错误保留
+CONFIG(release, debug|release): DEFINES += QT_NO_DEBUG_OUTPUT
+
 # 在 Ubuntu 上使用系统安装的 libarchive
 unix:!macx {
     CONFIG += link_pkgconfig
@@ -34,6 +37,27 @@ SOURCES += src/main.cpp \
     src/imagewidget_transform.cpp \
     src/imagewidget_view.cpp \
     src/imagewidget_viewmode.cpp \
+    src/imagewidget_watch.cpp \
+    src/imagewidget_sort.cpp \
+    src/folderwatcher.cpp \
+    src/exifreader.cpp \
+    src/imagesorter.cpp \
+    src/formatsniffer.cpp \
+    src/directoryscanner.cpp \
+    src/thumbnailloader.cpp \
+    src/threadpools.cpp \
+    src/thumbnaildiskcache.cpp \
+    src/thumbnailbatch.cpp \
+    src/trace.cpp \
+    src/logging.cpp \
+    src/metrics.cpp \
+    src/metricsserver.cpp \
+    src/alpharegion.cpp \
+    src/imagerendercache.cpp \
+    src/singleinstance.cpp \
+    src/startuptimer.cpp \
+    src/perfhud.cpp \
+    src/x11display.cpp \
     src/thumbnailwidget.cpp
 
 HEADERS += \
@@ -41,6 +65,27 @@ HEADERS += \
     src/canvasoverlay.h \
     src/canvascontrolpanel.h \
     src/configmanager.h \
+    src/folderwatcher.h \
+    src/exifreader.h \
+    src/imagesorter.h \
+    src/formatsniffer.h \
+    src/directoryscanner.h \
+    src/mpscqueue.h \
+    src/cancellationtoken.h \
+    src/thumbnailloader.h \
+    src/threadpools.h \
+    src/thumbnaildiskcache.h \
+    src/thumbnailbatch.h \
+    src/trace.h \
+    src/logging.h \
+    src/metrics.h \
+    src/metricsserver.h \
+    src/alpharegion.h \
+    src/imagerendercache.h \
+    src/singleinstance.h \
+    src/startuptimer.h \
+    src/perfhud.h \
+    src/x11display.h \
     src/imagewidget.h \
     src/platform_compat.h \
     src/thumbnailwidget.h
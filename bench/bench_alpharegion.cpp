@@ -0,0 +1,61 @@
+// bench_alpharegion.cpp
+#include <benchmark/benchmark.h>
+#include "alpharegion.h"
+#include <QPainter>
+
+namespace {
+
+// 典型的抠图素材：透明背景上的椭圆加几个镂空圆，每行有多个行程
+QImage cutoutImage(int side)
+{
+    QImage image(side, side, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    QPainter p(&image);
+    p.setRenderHint(QPainter::Antialiasing);
+    p.setPen(Qt::NoPen);
+    p.setBrush(Qt::black);
+    p.drawEllipse(QRectF(0, side * 0.1, side, side * 0.8));
+    p.setCompositionMode(QPainter::CompositionMode_Clear);
+    for (int i = 1; i <= 3; ++i) {
+        p.drawEllipse(QPointF(side * i / 4.0, side / 2.0), side / 12.0, side / 6.0);
+    }
+    return image;
+}
+
+// 提取：边长 512 为 updateMask 的采样上限
+void BM_AlphaRegionExtract(benchmark::State &state)
+{
+    const QImage image = cutoutImage(int(state.range(0)))
+                             .convertToFormat(QImage::Format_Alpha8);
+    qint64 rectCount = 0;
+
+    for (auto _ : state) {
+        QVector<QRect> rects = AlphaRegion::extract(image);
+        rectCount = rects.size();
+        benchmark::DoNotOptimize(rects);
+    }
+    state.counters["rects"] = double(rectCount);
+    state.SetItemsProcessed(state.iterations() * image.width() * image.height());
+}
+BENCHMARK(BM_AlphaRegionExtract)->Arg(200)->Arg(512)->Arg(2048)->Unit(benchmark::kMicrosecond);
+
+// 平移/缩放：缓存的形状映射到窗口并裁剪；参数 1 为旋转 90°（不再保持条带，需要排序）
+void BM_AlphaRegionMap(benchmark::State &state)
+{
+    const QVector<QRect> rects = AlphaRegion::extract(cutoutImage(1024));
+    const QRect window(0, 0, 1920, 1080);
+    const QTransform orientation = state.range(0) ? QTransform().rotate(90) * QTransform::fromTranslate(1024, 0)
+                                                : QTransform();
+    int step = 0;
+
+    for (auto _ : state) {
+        const QTransform view = orientation * QTransform::fromScale(2.0, 2.0)
+                                * QTransform::fromTranslate(-(step % 200), -(step % 150));
+        QVector<QRect> moved = AlphaRegion::mapped(rects, view, window);
+        benchmark::DoNotOptimize(moved);
+        ++step;
+    }
+}
+BENCHMARK(BM_AlphaRegionMap)->Arg(0)->Arg(1)->ArgNames({"rotated"})->Unit(benchmark::kMicrosecond);
+
+} // namespace
@@ -0,0 +1,43 @@
+// bench_archive.cpp
+#include <benchmark/benchmark.h>
+#include "benchcorpus.h"
+#include "archivehandler.h"
+
+namespace {
+
+// 在 N 个条目的 ZIP 中提取第一个 / 中间 / 最后一个条目
+void BM_ArchiveExtractFile(benchmark::State &state)
+{
+    const int entryCount = int(state.range(0));
+    const int position = int(state.range(1));   // 0 = 第一个，1 = 中间，2 = 最后
+
+    QStringList names;
+    const QString path = BenchCorpus::zipArchive(entryCount, &names);
+
+    ArchiveHandler handler;
+    if (names.isEmpty() || !handler.openArchive(path)) {
+        state.SkipWithError("failed to create benchmark archive");
+        return;
+    }
+
+    const int index = position == 0 ? 0 : position == 1 ? entryCount / 2 : entryCount - 1;
+    const QString entry = names.at(index);
+    static const char *const kPositions[] = {"first", "middle", "last"};
+    state.SetLabel(kPositions[position]);
+
+    for (auto _ : state) {
+        QByteArray data = handler.extractFile(entry);
+        if (data.isEmpty()) {
+            state.SkipWithError("entry not found");
+            break;
+        }
+        benchmark::DoNotOptimize(data);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ArchiveExtractFile)
+    ->ArgNames({"entries", "position"})
+    ->ArgsProduct({{10, 1000, 10000}, {0, 1, 2}})
+    ->Unit(benchmark::kMicrosecond);
+
+} // namespace
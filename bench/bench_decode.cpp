@@ -0,0 +1,52 @@
+// bench_decode.cpp
+#include <benchmark/benchmark.h>
+#include "benchcorpus.h"
+#include "thumbnailloader.h"
+#include <QFileInfo>
+
+namespace {
+
+const char *const kFormats[] = {"jpg", "png", "webp"};
+
+// 整个缩略图路径：读文件、按魔数选择解码器、解码、缩放到 250x250
+void BM_LoadImageFileFast(benchmark::State &state)
+{
+    const QByteArray format = kFormats[state.range(0)];
+    const QString path = BenchCorpus::imageFile(format);
+    if (path.isEmpty()) {
+        state.SkipWithError("image format not supported by this Qt build");
+        return;
+    }
+    state.SetLabel(format.constData());
+
+    for (auto _ : state) {
+        QImage image = ThumbnailLoader::loadImageFileFast(path, QSize(250, 250));
+        benchmark::DoNotOptimize(image);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * QFileInfo(path).size());
+}
+BENCHMARK(BM_LoadImageFileFast)->DenseRange(0, 2)->Unit(benchmark::kMillisecond);
+
+// 缩放：源图尺寸 x 目标边长
+void BM_ScaleImageWithAspectRatio(benchmark::State &state)
+{
+    const QSize sourceSize(int(state.range(0)), int(state.range(1)));
+    const QSize targetSize(int(state.range(2)), int(state.range(2)));
+    const QImage source = BenchCorpus::syntheticPhoto(sourceSize);
+
+    for (auto _ : state) {
+        QImage scaled = ThumbnailLoader::scaleImageWithAspectRatio(source, targetSize);
+        benchmark::DoNotOptimize(scaled);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ScaleImageWithAspectRatio)
+    ->ArgNames({"w", "h", "target"})
+    ->Args({640, 480, 250})
+    ->Args({1920, 1080, 250})
+    ->Args({4000, 3000, 250})
+    ->Args({4000, 3000, 1024})
+    ->Unit(benchmark::kMicrosecond);
+
+} // namespace
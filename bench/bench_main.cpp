@@ -0,0 +1,26 @@
+// bench_main.cpp
+// PictureView 性能测试入口：先创建 QApplication（ThumbnailWidget 需要），再交给 Google Benchmark。
+// 默认使用 offscreen 平台，可在没有显示器的机器上运行：
+//   ./PictureView_bench --benchmark_filter=Archive
+#include <benchmark/benchmark.h>
+#include <QApplication>
+#include <QImageReader>
+
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    // 测试过程中不输出调试日志，避免日志开销混入测量结果
+    qputenv("QT_LOGGING_RULES", "*.debug=false");
+
+    QApplication app(argc, argv);
+    app.setApplicationName("PictureView_bench");
+    QImageReader::setAllocationLimit(512);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,62 @@
+// bench_thumbnailgrid.cpp
+#include <benchmark/benchmark.h>
+#include "benchcorpus.h"
+#include "thumbnailwidget.h"
+#include "threadpools.h"
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <QPainter>
+#include <QImage>
+
+namespace {
+
+// 让可见项的加载请求和结果都处理完，之后的绘制不再触发新的加载
+void settle()
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < 200) {
+        QApplication::processEvents();
+        ThreadPools::io()->waitForDone();
+        ThreadPools::cpu()->waitForDone();
+    }
+    QApplication::processEvents();
+}
+
+// 离屏绘制一屏缩略图网格（视口位于列表中部），测量 paintEvent 本身的开销
+void BM_ThumbnailGridPaint(benchmark::State &state)
+{
+    const int itemCount = int(state.range(0));
+    const QSize viewport(1280, 800);
+
+    // 空目录中的虚构文件名：加载必然失败，失败占位图进入缓存后即稳定
+    QStringList names;
+    names.reserve(itemCount);
+    for (int i = 0; i < itemCount; ++i) {
+        names.append(QString("image_%1.jpg").arg(i, 6, 10, QChar('0')));
+    }
+
+    ThumbnailWidget widget;
+    widget.resize(viewport);
+    widget.setImageList(names, QDir(BenchCorpus::directory()));
+    widget.stopLoading();
+    widget.resize(viewport.width(), widget.minimumHeight());
+
+    const QRect source(0, qMax(0, widget.height() / 2 - viewport.height() / 2),
+                       viewport.width(), viewport.height());
+    QImage target(viewport, QImage::Format_ARGB32_Premultiplied);
+
+    widget.render(&target, QPoint(), QRegion(source));
+    settle();
+
+    for (auto _ : state) {
+        widget.render(&target, QPoint(), QRegion(source));
+        benchmark::DoNotOptimize(target.constBits());
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["items"] = itemCount;
+}
+BENCHMARK(BM_ThumbnailGridPaint)->Arg(1000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+
+} // namespace
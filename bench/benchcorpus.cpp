@@ -0,0 +1,107 @@
+// benchcorpus.cpp
+#include "benchcorpus.h"
+#include <QTemporaryDir>
+#include <QImageWriter>
+#include <QBuffer>
+#include <QFile>
+#include <QHash>
+#include <QPainter>
+#include <QLinearGradient>
+#include <QRandomGenerator>
+#include <archive.h>
+#include <archive_entry.h>
+
+namespace BenchCorpus
+{
+
+QString directory()
+{
+    static QTemporaryDir dir;
+    return dir.path();
+}
+
+QImage syntheticPhoto(const QSize &size)
+{
+    QImage image(size, QImage::Format_RGB32);
+
+    QPainter painter(&image);
+    QLinearGradient gradient(0, 0, size.width(), size.height());
+    gradient.setColorAt(0.0, QColor(30, 60, 120));
+    gradient.setColorAt(0.5, QColor(200, 160, 90));
+    gradient.setColorAt(1.0, QColor(40, 120, 60));
+    painter.fillRect(image.rect(), gradient);
+    painter.end();
+
+    QRandomGenerator random(20240601);
+    for (int y = 0; y < size.height(); ++y) {
+        QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(y));
+        for (int x = 0; x < size.width(); ++x) {
+            const int noise = int(random.bounded(32)) - 16;
+            const QRgb pixel = line[x];
+            line[x] = qRgb(qBound(0, qRed(pixel) + noise, 255),
+                           qBound(0, qGreen(pixel) + noise, 255),
+                           qBound(0, qBlue(pixel) + noise, 255));
+        }
+    }
+    return image;
+}
+
+QString imageFile(const QByteArray &format, const QSize &size)
+{
+    static QHash<QString, QString> generated;
+    const QString key = QString("%1-%2x%3").arg(QString::fromLatin1(format)).arg(size.width()).arg(size.height());
+    if (generated.contains(key)) return generated.value(key);
+
+    if (!QImageWriter::supportedImageFormats().contains(format)) return QString();
+
+    const QString path = directory() + "/" + key + "." + QString::fromLatin1(format);
+    QImageWriter writer(path, format);
+    writer.setQuality(90);
+    if (!writer.write(syntheticPhoto(size))) return QString();
+
+    generated.insert(key, path);
+    return path;
+}
+
+QString zipArchive(int entryCount, QStringList *entryNames)
+{
+    static QHash<int, QPair<QString, QStringList>> generated;
+    if (!generated.contains(entryCount)) {
+        // 条目内容相同，测量的是定位条目的开销而不是解压开销
+        QByteArray payload;
+        QBuffer buffer(&payload);
+        buffer.open(QIODevice::WriteOnly);
+        syntheticPhoto(QSize(64, 64)).save(&buffer, "png");
+
+        const QString path = directory() + QString("/entries-%1.zip").arg(entryCount);
+        QStringList names;
+
+        struct archive *writer = archive_write_new();
+        archive_write_set_format_zip(writer);
+        archive_write_open_filename(writer, QFile::encodeName(path).constData());
+
+        for (int i = 0; i < entryCount; ++i) {
+            const QString name = QString("images/%1.png").arg(i, 5, 10, QChar('0'));
+            names.append(name);
+
+            struct archive_entry *entry = archive_entry_new();
+            archive_entry_set_pathname(entry, name.toUtf8().constData());
+            archive_entry_set_size(entry, payload.size());
+            archive_entry_set_filetype(entry, AE_IFREG);
+            archive_entry_set_perm(entry, 0644);
+            archive_write_header(writer, entry);
+            archive_write_data(writer, payload.constData(), size_t(payload.size()));
+            archive_entry_free(entry);
+        }
+
+        archive_write_close(writer);
+        archive_write_free(writer);
+        generated.insert(entryCount, qMakePair(path, names));
+    }
+
+    const auto &archive = generated.value(entryCount);
+    if (entryNames) *entryNames = archive.second;
+    return archive.first;
+}
+
+} // namespace BenchCorpus
@@ -0,0 +1,27 @@
+// benchcorpus.h
+#ifndef BENCHCORPUS_H
+#define BENCHCORPUS_H
+
+#include <QString>
+#include <QStringList>
+#include <QImage>
+#include <QSize>
+
+// 性能测试用的样本文件：运行时在临时目录里生成，保证每次测量的输入完全相同，
+// 不依赖仓库里提交的二进制文件。
+namespace BenchCorpus
+{
+    // 可重复的"照片"内容：渐变加固定种子的噪声，避免纯色图被编码器过度压缩
+    QImage syntheticPhoto(const QSize &size);
+
+    // 按格式（"jpg"/"png"/"webp"）生成一张图片，返回路径；不支持的格式返回空串
+    QString imageFile(const QByteArray &format, const QSize &size = QSize(1920, 1080));
+
+    // 生成含 entryCount 个小 PNG 条目的 ZIP，entryNames 返回条目名（按写入顺序）
+    QString zipArchive(int entryCount, QStringList *entryNames = nullptr);
+
+    // 临时目录（进程退出时删除）
+    QString directory();
+}
+
+#endif // BENCHCORPUS_H
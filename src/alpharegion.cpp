@@ -0,0 +1,145 @@
+// alpharegion.cpp
+#include "alpharegion.h"
+#include "trace.h"
+#include <QtAlgorithms>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PV_ALPHAREGION_SSE2
+#endif
+
+namespace AlphaRegion
+{
+namespace
+{
+
+struct Run {
+    int start;
+    int end;     // 不含
+    bool operator==(const Run &other) const { return start == other.start && end == other.end; }
+};
+
+// 从 x 开始找到第一个 opaque 状态等于 wantOpaque 的位置（找不到返回 width）
+inline int scanUntil(const uchar *row, int x, int width, quint8 threshold, bool wantOpaque)
+{
+#ifdef PV_ALPHAREGION_SSE2
+    // alpha > threshold  <=>  max(alpha, threshold + 1) == alpha（无符号比较）
+    const __m128i limit = _mm_set1_epi8(char(threshold + 1));
+    while (x + 16 <= width) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + x));
+        const __m128i opaque = _mm_cmpeq_epi8(_mm_max_epu8(pixels, limit), pixels);
+        uint mask = uint(_mm_movemask_epi8(opaque));
+        if (!wantOpaque) mask = ~mask & 0xFFFFu;
+        if (mask) {
+            return x + int(qCountTrailingZeroBits(mask));
+        }
+        x += 16;
+    }
+#endif
+    while (x < width && (row[x] > threshold) != wantOpaque) {
+        ++x;
+    }
+    return x;
+}
+
+void scanRow(const uchar *row, int width, quint8 threshold, QVector<Run> &runs)
+{
+    runs.clear();
+    int x = 0;
+    while (x < width) {
+        const int start = scanUntil(row, x, width, threshold, true);
+        if (start >= width) break;
+        const int end = scanUntil(row, start, width, threshold, false);
+        runs.append({start, end});
+        x = end;
+    }
+}
+
+} // namespace
+
+QVector<QRect> extract(const QImage &image, int threshold)
+{
+    PV_TRACE_SCOPE_CAT("alphaRegionExtract", "mask");
+    QVector<QRect> rects;
+    if (image.isNull()) return rects;
+
+    const QImage alpha = image.format() == QImage::Format_Alpha8
+                             ? image
+                             : image.convertToFormat(QImage::Format_Alpha8);
+    const quint8 limit = quint8(qBound(0, threshold, 254));
+    const int width = alpha.width();
+
+    QVector<Run> previous;
+    QVector<Run> current;
+    int bandStart = 0;    // 当前条带在 rects 中的起始下标
+    for (int y = 0; y < alpha.height(); ++y) {
+        scanRow(alpha.constScanLine(y), width, limit, current);
+
+        if (y > 0 && current == previous) {
+            // 与上一行完全相同：把上一条带整体加高一行
+            for (int i = bandStart; i < rects.size(); ++i) {
+                rects[i].setHeight(rects[i].height() + 1);
+            }
+            continue;
+        }
+
+        bandStart = rects.size();
+        for (const Run &run : std::as_const(current)) {
+            rects.append(QRect(run.start, y, run.end - run.start, 1));
+        }
+        previous.swap(current);
+    }
+    return rects;
+}
+
+QTransform LevelRegion::toImage(const QSize &imageSize) const
+{
+    if (sampleSize.isEmpty()) return QTransform();
+    return QTransform::fromScale(double(imageSize.width()) / sampleSize.width(),
+                                 double(imageSize.height()) / sampleSize.height());
+}
+
+LevelRegion extractAtLevel(const QImage &image, int level, int threshold)
+{
+    LevelRegion region;
+    region.level = level;
+    if (image.isNull()) return region;
+
+    const int divisor = 1 << qBound(0, level, 16);
+    region.sampleSize = QSize(qMax(1, image.width() / divisor), qMax(1, image.height() / divisor));
+    region.rects = extract(region.sampleSize == image.size()
+                               ? image
+                               : image.scaled(region.sampleSize, Qt::IgnoreAspectRatio, Qt::FastTransformation),
+                           threshold);
+    return region;
+}
+
+QVector<QRect> mapped(const QVector<QRect> &rects, const QTransform &transform, const QRect &clip)
+{
+    PV_TRACE_SCOPE_CAT("alphaRegionMap", "mask");
+    QVector<QRect> result;
+    result.reserve(rects.size());
+    for (const QRect &r : rects) {
+        // 分别取整四条边，相邻矩形和条带共享的边映射到同一位置，不会出现缝隙或重叠
+        const QRectF f = transform.mapRect(QRectF(r));
+        const int left = qRound(f.left());
+        const int top = qRound(f.top());
+        const QRect out = QRect(left, top, qRound(f.right()) - left, qRound(f.bottom()) - top).intersected(clip);
+        if (!out.isEmpty()) {
+            result.append(out);
+        }
+    }
+    // 镜像会让条带或条带内的顺序反过来，重新排序即可
+    std::sort(result.begin(), result.end(), [](const QRect &a, const QRect &b) {
+        return a.y() != b.y() ? a.y() < b.y() : a.x() < b.x();
+    });
+    return result;
+}
+
+bool preservesBands(const QTransform &transform)
+{
+    return qFuzzyIsNull(transform.m12()) && qFuzzyIsNull(transform.m21());
+}
+
+} // namespace AlphaRegion
@@ -0,0 +1,37 @@
+// alpharegion.h
+#ifndef ALPHAREGION_H
+#define ALPHAREGION_H
+
+#include <QImage>
+#include <QRect>
+#include <QTransform>
+#include <QVector>
+
+// 透明窗口输入形状：从 alpha 通道直接生成矩形列表。
+// 每行按行程（连续不透明像素）编码，行程完全相同的相邻行合并为一个更高的矩形；
+// 结果按 y、x 排序且同一条带内高度一致，可直接作为 YXBanded 传给 XShapeCombineRectangles。
+// 阈值比较在支持 SSE2 的平台上一次处理 16 个像素。
+namespace AlphaRegion
+{
+    // alpha > threshold 的像素视为不透明。非 Alpha8 格式会先转换
+    QVector<QRect> extract(const QImage &image, int threshold = 30);
+
+    // 原图按 2^-level 缩小后提取的形状，坐标为缩小图的像素坐标
+    struct LevelRegion {
+        int level = -1;
+        QSize sampleSize;
+        QVector<QRect> rects;
+
+        // 缩小图坐标 → 原图坐标
+        QTransform toImage(const QSize &imageSize) const;
+    };
+    // 可在工作线程调用
+    LevelRegion extractAtLevel(const QImage &image, int level, int threshold = 30);
+
+    // 按变换映射到窗口坐标并裁剪到 clip 内，结果按 y、x 排序。
+    // 变换只含缩放/平移/镜像时条带结构保持不变；含 90° 旋转时行变成列，不再是 YX 分带
+    QVector<QRect> mapped(const QVector<QRect> &rects, const QTransform &transform, const QRect &clip);
+    bool preservesBands(const QTransform &transform);
+}
+
+#endif // ALPHAREGION_H
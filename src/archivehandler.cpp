@@ -1,4 +1,8 @@
 #include "archivehandler.h"
+#include "trace.h"
+#include "logging.h"
+#include "metrics.h"
+#include "formatsniffer.h"
 #include <QFileInfo>
 #include <QDebug>
 
@@ -13,12 +17,7 @@ ArchiveHandler::~ArchiveHandler()
 
 bool ArchiveHandler::isSupportedArchive(const QString &filePath)
 {
-    QFileInfo fileInfo(filePath);
-    QString suffix = fileInfo.suffix().toLower();
-
-    // 支持的压缩格式
-    return (suffix == "zip" || suffix == "rar" || suffix == "7z" ||
-            suffix == "tar" || suffix == "gz" || suffix == "bz2");
+    return FormatSniffer::isArchiveFile(filePath);
 }
 
 bool ArchiveHandler::openArchive(const QString &filePath)
@@ -32,7 +31,7 @@ bool ArchiveHandler::openArchive(const QString &filePath)
     int r = archive_read_open_filename(
         archive, filePath.toLocal8Bit().constData(), 10240);
     if (r != ARCHIVE_OK) {
-        qDebug() << "Failed to open archive:" << filePath
+        qCWarning(lcArchive) << "Failed to open archive:" << filePath
                  << archive_error_string(archive);
         archive_read_free(archive);
         archive = nullptr;
@@ -55,12 +54,11 @@ void ArchiveHandler::closeArchive()
 
 QStringList ArchiveHandler::getImageFiles()
 {
+    PV_TRACE_SCOPE_CAT("listArchive", "archive");
     QStringList imageFiles;
 
     if (!archive) return imageFiles;
 
-    qDebug() << "=== 获取压缩包内图片文件列表 ===";
-
     // 保存当前读取位置
     int currentPosition = archive_read_header_position(archive);
 
@@ -79,20 +77,24 @@ QStringList ArchiveHandler::getImageFiles()
             QString filePath = QString::fromUtf8(filename);
             entryCount++;
 
-            qDebug() << "找到文件" << entryCount << ":" << filePath;
+            // 扩展名未知的条目读取前 32 字节按魔数判断
+            FormatSniffer::Format format = FormatSniffer::fromFileName(filePath);
+            if (format == FormatSniffer::Unknown && archive_entry_filetype(entry) == AE_IFREG) {
+                char header[FormatSniffer::kHeaderSize];
+                la_ssize_t headerSize = archive_read_data(archive, header, sizeof(header));
+                if (headerSize > 0) {
+                    format = FormatSniffer::fromHeader(QByteArray(header, int(headerSize)));
+                }
+            }
 
-            if (isImageFile(filePath)) {
+            if (FormatSniffer::isImage(format)) {
                 imageFiles.append(filePath);
-                qDebug() << "  ✅ 识别为图片文件";
-            } else {
-                qDebug() << "  ❌ 不是图片文件";
             }
         }
         archive_read_data_skip(archive);
     }
 
-    qDebug() << "总共找到" << entryCount << "个文件，其中图片文件:" << imageFiles.size();
-    qDebug() << "图片文件列表:" << imageFiles;
+    qCDebug(lcArchive) << "压缩包条目:" << entryCount << "图片:" << imageFiles.size();
 
     // 重新打开以准备后续读取（保持原有逻辑）
     archive_read_free(archive);
@@ -106,16 +108,16 @@ QStringList ArchiveHandler::getImageFiles()
 
 QByteArray ArchiveHandler::extractFile(const QString &filePath)
 {
+    PV_TRACE_SCOPE_CAT("extractFile", "archive");
     QByteArray data;
 
     if (!archive) {
-        qDebug() << "❌ ArchiveHandler: archive 为 null";
+        qCWarning(lcArchive) << "extractFile: 压缩包未打开";
         return data;
     }
 
-    qDebug() << "=== ArchiveHandler 提取文件 ===";
-    qDebug() << "目标文件:" << filePath;
-    qDebug() << "当前archive路径:" << archivePath;
+    // 提取耗时（含打开和顺序查找）计入分位数统计
+    const qint64 startNs = Trace::now();
 
     // 使用新的archive实例来避免影响当前状态
     struct archive *tempArchive = archive_read_new();
@@ -124,7 +126,7 @@ QByteArray ArchiveHandler::extractFile(const QString &filePath)
 
     int r = archive_read_open_filename(tempArchive, archivePath.toLocal8Bit().constData(), 10240);
     if (r != ARCHIVE_OK) {
-        qDebug() << "❌ 无法打开临时archive:" << archive_error_string(tempArchive);
+        qCWarning(lcArchive) << "❌ 无法打开临时archive:" << archive_error_string(tempArchive);
         archive_read_free(tempArchive);
         return data;
     }
@@ -137,66 +139,84 @@ QByteArray ArchiveHandler::extractFile(const QString &filePath)
         const char *filename = archive_entry_pathname(entry);
         scannedFiles++;
 
-        if (filename) {
-            QString currentFile = QString::fromUtf8(filename);
-            qDebug() << "扫描文件" << scannedFiles << ":" << currentFile;
-
-            if (currentFile == filePath) {
-                qDebug() << "✅ 找到目标文件，开始提取数据";
-                found = true;
-
-                // 读取数据
-                const void *buff;
-                size_t size;
-                la_int64_t offset;
-                int dataBlocks = 0;
-                int totalSize = 0;
-
-                while (archive_read_data_block(tempArchive, &buff, &size, &offset) == ARCHIVE_OK) {
-                    data.append(static_cast<const char *>(buff), size);
-                    dataBlocks++;
-                    totalSize += size;
-                    qDebug() << "  数据块" << dataBlocks << "大小:" << size << "偏移:" << offset;
-                }
-                qDebug() << "提取完成: 数据块:" << dataBlocks << "总大小:" << totalSize;
-                break;
+        if (filename && QString::fromUtf8(filename) == filePath) {
+            found = true;
+
+            // 读取数据
+            const void *buff;
+            size_t size;
+            la_int64_t offset;
+            while (archive_read_data_block(tempArchive, &buff, &size, &offset) == ARCHIVE_OK) {
+                data.append(static_cast<const char *>(buff), size);
             }
+            break;
         }
         archive_read_data_skip(tempArchive);
     }
 
     if (!found) {
-        qDebug() << "❌ 未找到文件:" << filePath << "扫描了" << scannedFiles << "个文件";
-
-        // 输出前几个文件用于调试
-        qDebug() << "前5个文件:";
-        // 重新扫描输出前5个文件
-        archive_read_free(tempArchive);
-        tempArchive = archive_read_new();
-        archive_read_support_format_all(tempArchive);
-        archive_read_support_filter_all(tempArchive);
-        archive_read_open_filename(tempArchive, archivePath.toLocal8Bit().constData(), 10240);
-
-        for (int i = 0; i < 5 && archive_read_next_header(tempArchive, &entry) == ARCHIVE_OK; i++) {
-            const char *filename = archive_entry_pathname(entry);
-            if (filename) {
-                qDebug() << "  " << i+1 << ":" << QString::fromUtf8(filename);
-            }
-            archive_read_data_skip(tempArchive);
-        }
+        qCWarning(lcArchive) << "压缩包中未找到文件:" << filePath << "扫描了" << scannedFiles << "个条目";
     }
 
     archive_read_close(tempArchive);
     archive_read_free(tempArchive);
 
+    Metrics::recordExtraction(Trace::now() - startNs);
     return data;
 }
 
-bool ArchiveHandler::isImageFile(const QString &fileName)
+bool ArchiveHandler::forEachImage(const std::function<bool(const QString &name)> &filter,
+                                  const std::function<bool(const QString &name, const QByteArray &data)> &visitor)
 {
-    QString lowerName = fileName.toLower();
-    return (lowerName.endsWith(".png") || lowerName.endsWith(".jpg") ||
-            lowerName.endsWith(".jpeg") || lowerName.endsWith(".bmp") ||
-            lowerName.endsWith(".webp") || lowerName.endsWith(".gif") ||
-            lowerName.endsWith(".tiff") || lowerName.endsWith(".tif"));
+    PV_TRACE_SCOPE_CAT("scanArchive", "archive");
+    if (!archive) return false;
+
+    // 与 extractFile 一样使用独立的 archive 实例
+    struct archive *tempArchive = archive_read_new();
+    archive_read_support_format_all(tempArchive);
+    archive_read_support_filter_all(tempArchive);
+
+    if (archive_read_open_filename(tempArchive, archivePath.toLocal8Bit().constData(), 10240) != ARCHIVE_OK) {
+        qCWarning(lcArchive) << "❌ 无法打开临时archive:" << archive_error_string(tempArchive);
+        archive_read_free(tempArchive);
+        return false;
+    }
+
+    struct archive_entry *entry;
+    while (archive_read_next_header(tempArchive, &entry) == ARCHIVE_OK) {
+        const char *filename = archive_entry_pathname(entry);
+        if (!filename || archive_entry_filetype(entry) != AE_IFREG) {
+            archive_read_data_skip(tempArchive);
+            continue;
+        }
+
+        QString name = QString::fromUtf8(filename);
+        FormatSniffer::Format format = FormatSniffer::fromFileName(name);
+        // 扩展名已知且不是图片的条目不解压
+        if ((format != FormatSniffer::Unknown && !FormatSniffer::isImage(format))
+            || (filter && !filter(name))) {
+            archive_read_data_skip(tempArchive);
+            continue;
+        }
+
+        QByteArray data;
+        const void *buff;
+        size_t size;
+        la_int64_t offset;
+        while (archive_read_data_block(tempArchive, &buff, &size, &offset) == ARCHIVE_OK) {
+            data.append(static_cast<const char *>(buff), size);
+        }
+
+        // 扩展名未知的条目按魔数判断
+        if (format == FormatSniffer::Unknown
+            && !FormatSniffer::isImage(FormatSniffer::fromHeader(data.left(FormatSniffer::kHeaderSize)))) {
+            continue;
+        }
+
+        if (!visitor(name, data)) break;
+    }
+
+    archive_read_close(tempArchive);
+    archive_read_free(tempArchive);
+    return true;
 }
@@ -4,6 +4,7 @@
 #include <QString>
 #include <QStringList>
 #include <QByteArray>
+#include <functional>
 #include <archive.h>
 #include <archive_entry.h>
 
@@ -28,6 +29,12 @@ public:
     // 从压缩包中提取文件到内存
     QByteArray extractFile(const QString &filePath);
 
+    // 单次遍历整个压缩包，依次解压图片条目交给 visitor（返回 false 时停止）。
+    // filter 可为空；返回 false 的条目直接跳过、不解压。批量处理时代替逐个 extractFile，
+    // 避免每个条目都从头扫描一遍压缩包。
+    bool forEachImage(const std::function<bool(const QString &name)> &filter,
+                      const std::function<bool(const QString &name, const QByteArray &data)> &visitor);
+
     // 获取压缩包基本信息
     QString getArchivePath() const { return archivePath; }
     bool isOpen() const { return archive != nullptr; }
@@ -35,9 +42,6 @@ public:
 private:
     struct archive *archive;
     QString archivePath;
-
-    // 检查文件是否是图片
-    bool isImageFile(const QString &fileName);
 };
 
 #endif // ARCHIVEHANDLER_H
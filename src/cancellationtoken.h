@@ -0,0 +1,48 @@
+// cancellationtoken.h
+#ifndef CANCELLATIONTOKEN_H
+#define CANCELLATIONTOKEN_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <memory>
+
+// 后台任务的取消令牌：记录提交时的"代"，所属的 GenerationCounter 前进后即视为取消。
+// 任务只持有共享的计数器，不持有窗口指针，窗口销毁后检查依然安全。
+class CancellationToken
+{
+public:
+    CancellationToken() = default;   // 默认构造的令牌永不取消
+
+    bool isCancelled() const
+    {
+        return m_state && m_state->load(std::memory_order_acquire) != m_generation;
+    }
+    quint64 generation() const { return m_generation; }
+
+private:
+    friend class GenerationCounter;
+    CancellationToken(std::shared_ptr<std::atomic<quint64>> state, quint64 generation)
+        : m_state(std::move(state)), m_generation(generation) {}
+
+    std::shared_ptr<std::atomic<quint64>> m_state;
+    quint64 m_generation = 0;
+};
+
+// 每次切换目录/压缩包时调用 advance()，之前发出的所有令牌立即失效
+class GenerationCounter
+{
+public:
+    GenerationCounter() : m_state(std::make_shared<std::atomic<quint64>>(0)) {}
+
+    CancellationToken token() const
+    {
+        return CancellationToken(m_state, m_state->load(std::memory_order_acquire));
+    }
+    quint64 current() const { return m_state->load(std::memory_order_acquire); }
+    void advance() { m_state->fetch_add(1, std::memory_order_acq_rel); }
+
+private:
+    std::shared_ptr<std::atomic<quint64>> m_state;
+};
+
+#endif // CANCELLATIONTOKEN_H
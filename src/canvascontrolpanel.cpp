@@ -9,12 +9,13 @@ CanvasControlPanel::CanvasControlPanel(QWidget *parent)
     : QWidget(parent),
     mouseOver(false),
     buttonHover(false),
+    referenceButtonHover(false),
     isDragging(false)
 {
     // 设置窗口属性
     setWindowFlags(Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint | Qt::Tool);
     setAttribute(Qt::WA_TranslucentBackground);
-    setFixedSize(120, 40);
+    setFixedSize(200, 40);
 
     // 启用鼠标跟踪
     setMouseTracking(true);
@@ -27,8 +28,9 @@ void CanvasControlPanel::paintEvent(QPaintEvent *event)
     QPainter painter(this);
     painter.setRenderHint(QPainter::Antialiasing);
 
-    // 计算按钮区域
-    buttonRect = QRect(10, 5, width() - 20, height() - 10);
+    // 计算按钮区域：左边参考图，右边退出
+    referenceButtonRect = QRect(10, 5, 80, height() - 10);
+    buttonRect = QRect(100, 5, width() - 110, height() - 10);
 
     // 绘制背景
     if (mouseOver) {
@@ -48,10 +50,19 @@ void CanvasControlPanel::paintEvent(QPaintEvent *event)
     painter.setPen(QPen(QColor(255, 255, 255, 150), 1));
     painter.drawRoundedRect(buttonRect, 3, 3);
 
+    // 参考图按钮
+    if (referenceButtonHover) {
+        painter.setBrush(QColor(90, 120, 170, 255));
+    } else {
+        painter.setBrush(QColor(70, 95, 140, 255));
+    }
+    painter.drawRoundedRect(referenceButtonRect, 3, 3);
+
     // 绘制按钮文字
     painter.setPen(Qt::white);
     painter.setFont(QFont("Arial", 9, QFont::Bold));
     painter.drawText(buttonRect, Qt::AlignCenter, tr("退出画布"));
+    painter.drawText(referenceButtonRect, Qt::AlignCenter, tr("参考图"));
 }
 
 void CanvasControlPanel::mousePressEvent(QMouseEvent *event)
@@ -60,6 +71,8 @@ void CanvasControlPanel::mousePressEvent(QMouseEvent *event)
         if (buttonRect.contains(event->pos())) {
             // 点击按钮，退出画布模式
             emit exitCanvasMode();
+        } else if (referenceButtonRect.contains(event->pos())) {
+            emit referenceMenuRequested(mapToGlobal(referenceButtonRect.bottomLeft()));
         } else {
             // 点击非按钮区域，开始拖拽
             isDragging = true;
@@ -74,9 +87,11 @@ void CanvasControlPanel::mouseMoveEvent(QMouseEvent *event)
 {
     // 更新按钮悬停状态
     bool oldHover = buttonHover;
+    bool oldReferenceHover = referenceButtonHover;
     buttonHover = buttonRect.contains(event->pos());
+    referenceButtonHover = referenceButtonRect.contains(event->pos());
 
-    if (oldHover != buttonHover) {
+    if (oldHover != buttonHover || oldReferenceHover != referenceButtonHover) {
         update(); // 重绘以更新按钮颜色
     }
 
@@ -107,5 +122,6 @@ void CanvasControlPanel::leaveEvent(QEvent *event)
     Q_UNUSED(event);
     mouseOver = false;
     buttonHover = false;
+    referenceButtonHover = false;
     update(); // 重绘以更新背景和按钮颜色
 }
@@ -14,6 +14,8 @@ public:
 
 signals:
     void exitCanvasMode();
+    // 画布模式下主窗口隐藏、覆盖层鼠标穿透，参考图的调整菜单从这里打开
+    void referenceMenuRequested(const QPoint &globalPos);
 
 protected:
     void paintEvent(QPaintEvent *event) override;
@@ -26,9 +28,11 @@ protected:
 private:
     bool mouseOver;
     bool buttonHover;
+    bool referenceButtonHover;
     bool isDragging;
     QPoint dragStartPosition;
     QRect buttonRect;
+    QRect referenceButtonRect;
 };
 
 #endif // CANVASCONTROLPANEL_H
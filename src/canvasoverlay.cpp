@@ -3,8 +3,12 @@
 #include "imagewidget.h"
 #include "qapplication.h"
 #include <QPainter>
+#include <QPaintEvent>
 #include <QTimer>
 #include <QDebug>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+#include "threadpools.h"
 
 #ifdef Q_OS_LINUX
 #include <QGuiApplication>
@@ -13,6 +17,7 @@ extern "C" {
 #include <X11/extensions/shape.h>
 #include <X11/Xatom.h>
 }
+#include "x11display.h"
 #endif
 
 // canvasoverlay.cpp - 修改构造函数
@@ -41,11 +46,45 @@ CanvasOverlay::~CanvasOverlay()
 
 void CanvasOverlay::setImage(const QPixmap& pixmap)
 {
-    m_displayPixmap = pixmap;
-    update();
+    setContent(pixmap, QTransform());
+    setView(m_displayState.scaleFactor, m_displayState.panOffset, QRect());
 }
 
-// canvasoverlay.cpp - 修改paintEvent，复制主窗口的绘制逻辑
+// 图片在覆盖层中的显示区域
+QRect CanvasOverlay::calculateImageRect() const
+{
+    // 直接使用主窗口的计算结果：画布窗口和主窗口大小位置相同，只需换算原点
+    if (m_displayState.imageRect.isValid()) {
+        if (m_parentWidget.isNull()) return m_displayState.imageRect;
+        return m_displayState.imageRect.translated(geometry().topLeft() - m_parentWidget->geometry().topLeft());
+    }
+
+    // 重新计算（主窗口未提供显示区域时）
+    QRect targetRect(QPoint(0, 0), m_displayState.displaySize() * m_displayState.scaleFactor);
+    targetRect.moveCenter(rect().center() + m_displayState.panOffset.toPoint());
+    return targetRect;
+}
+
+QRect CanvasOverlay::imageDamageRect() const
+{
+    if (m_displayState.pixmap.isNull()) return QRect();
+    const QRect targetRect = calculateImageRect();
+    // 边框线宽 2 像素，一半画在图片外侧
+    return targetRect.adjusted(-2, -2, 2, 2).united(scaleLabelRect(targetRect));
+}
+
+QRect CanvasOverlay::scaleLabelRect(const QRect& imageRect)
+{
+    return QRect(imageRect.right() - 150, imageRect.bottom() - 25, 150, 20);
+}
+
+QRect CanvasOverlay::hintRect() const
+{
+    return QRect(0, height() - 30, width(), 30);
+}
+
+// 与主窗口相同的按需渲染：原图与主窗口共享，可见块的缩放结果也共用主窗口的缓存，
+// 进入画布模式不复制整图，参数不变的重绘不再缩放
 void CanvasOverlay::paintEvent(QPaintEvent* event)
 {
     // 检查父窗口是否仍然存活
@@ -57,54 +96,23 @@ void CanvasOverlay::paintEvent(QPaintEvent* event)
 
     QPainter painter(this);
 
-    qDebug() << "CanvasOverlay::paintEvent - 开始绘制";
-    // qDebug() << "  窗口尺寸:" << size();
-    // qDebug() << "  图片是否为空:" << m_displayState.image.isNull();
-    // qDebug() << "  图片尺寸:" << m_displayState.image.size();
-    // qDebug() << "  缩放比例:" << m_displayState.scaleFactor;
-    // qDebug() << "  平移偏移:" << m_displayState.panOffset;
-
-    // // 1. 填充背景（比主窗口稍暗）
-    // painter.fillRect(rect(), QColor(25, 25, 35, 180));
-
-    // // 2. 绘制网格背景
-    // painter.setPen(QPen(QColor(60, 60, 80, 50), 1));
-    // for (int x = 0; x < width(); x += 50) {
-    //     painter.drawLine(x, 0, x, height());
-    // }
-    // for (int y = 0; y < height(); y += 50) {
-    //     painter.drawLine(0, y, width(), y);
-    // }
-
-    // 3. 如果有图片，按照主窗口的显示方式绘制
-    if (!m_displayState.image.isNull()) {
-        qDebug() << "按照主窗口方式绘制图片...";
-
-        // 方法1：直接使用主窗口的计算结果
-        if (m_displayState.imageRect.isValid()) {
-            // 计算在画布窗口中的对应位置
-            // 由于画布窗口和主窗口大小位置相同，可以直接使用
-            QRect targetRect = m_displayState.imageRect;
-            targetRect.translate(geometry().topLeft() - m_parentWidget->geometry().topLeft());
-
-            qDebug() << "  使用主窗口显示区域:" << m_displayState.imageRect;
-            qDebug() << "  画布中目标区域:" << targetRect;
-
-            // 绘制图片（使用与主窗口相同的缩放）
-            painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
-
-            // 如果需要缩放，先缩放图片
-            QImage scaledImage = m_displayState.image;
-            if (m_displayState.scaleFactor != 1.0) {
-                scaledImage = m_displayState.image.scaled(
-                    m_displayState.image.size() * m_displayState.scaleFactor,
-                    Qt::KeepAspectRatio,
-                    Qt::SmoothTransformation
-                    );
-            }
-
-            painter.drawImage(targetRect, scaledImage);
+    if (!m_displayState.pixmap.isNull()) {
+        const double scale = m_displayState.scaleFactor;
+        const QRect targetRect = calculateImageRect();
+        const QTransform view = m_displayState.orientation
+                                * QTransform::fromScale(scale, scale)
+                                * QTransform::fromTranslate(targetRect.left(), targetRect.top());
+        painter.setOpacity(m_displayState.opacity);
+        if (m_surface.sameContent(m_displayState.pixmap, m_displayState.orientation)) {
+            drawSurface(painter, m_surface, m_displayState.pixmap, m_displayState.orientation,
+                        scale, targetRect.topLeft());
+        } else {
+            // 可见块按整个窗口计算（与主窗口的缓存键一致），实际只刷新受损区域
+            m_parentWidget->sharedRenderCache()->draw(painter, m_displayState.pixmap, view, scale, rect());
+        }
+        painter.setOpacity(1.0);
 
+        if (m_displayState.imageRect.isValid()) {
             // 绘制图片边框
             painter.setPen(QPen(QColor(200, 200, 255, 150), 2));
             painter.setBrush(Qt::NoBrush);
@@ -113,66 +121,26 @@ void CanvasOverlay::paintEvent(QPaintEvent* event)
             // 绘制信息
             painter.setPen(QColor(180, 200, 255, 180));
             painter.setFont(QFont("Arial", 10));
-            painter.drawText(targetRect.bottomRight() - QPoint(150, 5),
-                             QString("缩放: %1%").arg(int(m_displayState.scaleFactor * 100)));
+            painter.drawText(scaleLabelRect(targetRect), Qt::AlignLeft | Qt::AlignBottom,
+                             QString("缩放: %1%").arg(int(scale * 100)));
         }
-        // 方法2：重新计算（如果方法1不可用）
-        else {
-            // 复制主窗口的缩放逻辑
-            QSize scaledSize = m_displayState.image.size() * m_displayState.scaleFactor;
-            QRect targetRect = QRect(QPoint(0, 0), scaledSize);
-            targetRect.moveCenter(rect().center() + m_displayState.panOffset.toPoint());
-
-            qDebug() << "  重新计算目标区域:" << targetRect;
-
-            // 绘制图片
-            painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
-
-            QImage scaledImage = m_displayState.image;
-            if (m_displayState.scaleFactor != 1.0) {
-                scaledImage = m_displayState.image.scaled(
-                    scaledSize,
-                    Qt::KeepAspectRatio,
-                    Qt::SmoothTransformation
-                    );
-            }
-
-            painter.drawImage(targetRect, scaledImage);
-
-            // // 绘制边框和信息
-            // painter.setPen(QPen(QColor(200, 200, 255, 150), 2));
-            // painter.setBrush(Qt::NoBrush);
-            // painter.drawRect(targetRect);
-        }
-    } else if (!m_displayPixmap.isNull()) {
-        // 备用：使用QPixmap绘制
-        qDebug() << "使用QPixmap绘制图片...";
-
-        QSize scaledSize = m_displayPixmap.size() * m_displayState.scaleFactor;
-        QRect targetRect = QRect(QPoint(0, 0), scaledSize);
-        targetRect.moveCenter(rect().center() + m_displayState.panOffset.toPoint());
-
-        painter.drawPixmap(targetRect, m_displayPixmap.scaled(
-                                           scaledSize, Qt::KeepAspectRatio, Qt::SmoothTransformation));
     }
 
-    // // 4. 绘制窗口装饰
-    // // 标题区域
-    // QRect titleRect(0, 0, width(), 35);
-    // QLinearGradient titleGradient(0, 0, 0, titleRect.height());
-    // titleGradient.setColorAt(0, QColor(50, 60, 90, 220));
-    // titleGradient.setColorAt(1, QColor(40, 50, 80, 220));
-    // painter.fillRect(titleRect, titleGradient);
+    // 参考图：只绘制与受损区域相交的
+    for (const ReferenceLayer &layer : std::as_const(m_references)) {
+        const Reference &reference = layer.reference;
+        const QRect referenceRect = reference.rect();
+        if (!event->region().intersects(referenceDamageRect(reference))) continue;
 
-    // // 标题文字
-    // painter.setPen(QColor(220, 230, 255, 230));
-    // painter.setFont(QFont("Arial", 11, QFont::Bold));
-    // painter.drawText(titleRect.adjusted(10, 0, -10, 0), Qt::AlignVCenter, "画布模式 - 图片置顶显示");
+        painter.setOpacity(reference.opacity);
+        drawSurface(painter, layer.surface, reference.pixmap, reference.orientation,
+                    reference.scale, reference.position);
+        painter.setOpacity(1.0);
 
-    // // 窗口边框
-    // painter.setPen(QPen(QColor(80, 120, 200, 200), 3));
-    // painter.setBrush(Qt::NoBrush);
-    // painter.drawRect(rect().adjusted(1, 1, -2, -2));
+        painter.setPen(QPen(QColor(200, 200, 255, 120), 1));
+        painter.setBrush(Qt::NoBrush);
+        painter.drawRect(referenceRect.adjusted(0, 0, -1, -1));
+    }
 
     // 操作提示
     painter.setPen(QColor(180, 190, 220, 180));
@@ -180,21 +148,262 @@ void CanvasOverlay::paintEvent(QPaintEvent* event)
     QString hint = QString("ESC退出 | 拖动调整位置 | Ctrl+滚轮缩放 (%1%)")
                        .arg(int(m_displayState.scaleFactor * 100));
     painter.drawText(10, height() - 10, hint);
-
-    qDebug() << "CanvasOverlay::paintEvent - 绘制完成";
 }
 
-// canvasoverlay.cpp - 修改 setDisplayState 函数
 void CanvasOverlay::setDisplayState(const DisplayState& state)
 {
-    m_displayState = state;
+    setContent(state.pixmap, state.orientation);
+    setView(state.scaleFactor, state.panOffset, state.imageRect);
+    setImageOpacity(state.opacity);
+}
+
+void CanvasOverlay::setContent(const QPixmap& pixmap, const QTransform& orientation)
+{
+    if (pixmap.cacheKey() == m_displayState.pixmap.cacheKey() && orientation == m_displayState.orientation) {
+        return;
+    }
+
+    const QRect before = imageDamageRect();
+    m_displayState.pixmap = pixmap;   // 只复制共享的 QPixmap 句柄
+    m_displayState.orientation = orientation;
+    m_surface = Surface();            // 旧表面属于另一张图，不能拉伸顶替
+    pruneMips();
+    requestSurface();
+    update(QRegion(before) + imageDamageRect());
+}
+
+void CanvasOverlay::setView(double scaleFactor, const QPointF& panOffset, const QRect& imageRect)
+{
+    const bool scaleChanged = scaleFactor != m_displayState.scaleFactor;
+    if (!scaleChanged && panOffset == m_displayState.panOffset && imageRect == m_displayState.imageRect) {
+        return;
+    }
+
+    const QRect before = imageDamageRect();
+    m_displayState.scaleFactor = scaleFactor;
+    m_displayState.panOffset = panOffset;
+    m_displayState.imageRect = imageRect;
+
+    QRegion damage = QRegion(before) + imageDamageRect();
+    if (scaleChanged) {
+        damage += hintRect();   // 提示里显示缩放百分比
+        requestSurface();
+    }
+    update(damage);
+}
+
+// 预缩放整图超过窗口面积的 4 倍时（大幅放大）不值得常驻内存
+bool CanvasOverlay::surfaceWorthKeeping(const QSizeF& size) const
+{
+    const qreal maxArea = 4.0 * qMax(1, width()) * qMax(1, height());
+    return size.width() * size.height() <= maxArea;
+}
+
+void CanvasOverlay::buildSurface(const QPixmap& pixmap, const QTransform& orientation, double scale,
+                                 const CancellationToken& token, std::function<void(Surface)> done)
+{
+    Surface request;
+    request.sourceKey = pixmap.cacheKey();
+    request.orientation = orientation;
+    request.scale = scale;
+    // 光栅平台上 QPixmap::toImage 是浅拷贝，不复制像素
+    const QImage source = pixmap.toImage();
+    const QVector<QImage> mips = m_mips.value(request.sourceKey);
+    const bool needMips = !m_mips.contains(request.sourceKey);
+
+    struct Result {
+        QImage image;
+        QVector<QImage> mips;
+    };
+    QFuture<Result> future = QtConcurrent::run(ThreadPools::cpu(), [source, mips, needMips, request, token]() {
+        Result result;
+        if (token.isCancelled()) return result;
+        // 第一次用到这张图时建立 mip 链，之后任何缩放都从不小于目标的最小一级出发
+        result.mips = needMips ? ImageRenderCache::mipChain(source) : mips;
+        const QImage level = ImageRenderCache::mipFor(source, result.mips, request.scale);
+        const double levelScale = request.scale * source.width() / qMax(1, level.width());
+        result.image = ImageRenderCache::prescaled(level, request.orientation, levelScale);
+        return result;
+    });
+
+    auto *watcher = new QFutureWatcher<Result>(this);
+    connect(watcher, &QFutureWatcher<Result>::finished, this, [this, watcher, request, needMips, token, done]() {
+        Result result = watcher->result();
+        watcher->deleteLater();
+        if (token.isCancelled() || result.image.isNull()) return;
+
+        if (needMips && !m_mips.contains(request.sourceKey)) {
+            m_mips.insert(request.sourceKey, result.mips);
+        }
+
+        Surface surface = request;
+        surface.image = std::move(result.image);
+        done(std::move(surface));
+    });
+    watcher->setFuture(future);
+}
+
+void CanvasOverlay::drawSurface(QPainter& painter, const Surface& surface, const QPixmap& pixmap,
+                                const QTransform& orientation, double scale, const QPointF& topLeft) const
+{
+    if (surface.matches(pixmap, orientation, scale)) {
+        // 预缩放表面：直接贴图，不插值
+        painter.drawImage(topLeft, surface.image);
+    } else if (surface.sameContent(pixmap, orientation)) {
+        // 新表面还在后台生成：先把旧表面拉伸到新尺寸顶替
+        const QSizeF size = orientation.mapRect(QRectF(pixmap.rect())).size() * scale;
+        painter.drawImage(QRectF(topLeft, size), surface.image);
+    } else {
+        painter.save();
+        painter.setRenderHint(QPainter::SmoothPixmapTransform);
+        painter.setTransform(orientation * QTransform::fromScale(scale, scale)
+                             * QTransform::fromTranslate(topLeft.x(), topLeft.y()), true);
+        painter.drawPixmap(0, 0, pixmap);
+        painter.restore();
+    }
+}
+
+void CanvasOverlay::requestSurface()
+{
+    // 作废正在生成的旧尺寸表面
+    m_surfaceGeneration.advance();
+    const QPixmap &pixmap = m_displayState.pixmap;
+    if (pixmap.isNull() || m_surface.matches(pixmap, m_displayState.orientation, m_displayState.scaleFactor)) {
+        return;
+    }
+
+    // 表面过大时改用与主窗口共用的可见块缓存
+    if (!surfaceWorthKeeping(QSizeF(m_displayState.displaySize()) * m_displayState.scaleFactor)) {
+        m_surface = Surface();
+        return;
+    }
+
+    buildSurface(pixmap, m_displayState.orientation, m_displayState.scaleFactor,
+                 m_surfaceGeneration.token(), [this](Surface surface) {
+                     m_surface = std::move(surface);
+                     update(calculateImageRect());
+                 });
+}
+
+// 只保留仍在显示的图片的 mip 链
+void CanvasOverlay::pruneMips()
+{
+    for (auto it = m_mips.begin(); it != m_mips.end();) {
+        bool used = it.key() == m_displayState.pixmap.cacheKey();
+        for (const ReferenceLayer &layer : std::as_const(m_references)) {
+            used = used || it.key() == layer.reference.pixmap.cacheKey();
+        }
+        it = used ? std::next(it) : m_mips.erase(it);
+    }
+}
+
+CanvasOverlay::ReferenceLayer* CanvasOverlay::findReference(int id)
+{
+    for (ReferenceLayer &layer : m_references) {
+        if (layer.id == id) return &layer;
+    }
+    return nullptr;
+}
+
+QRect CanvasOverlay::referenceDamageRect(const Reference& reference)
+{
+    // 边框线宽 1 像素
+    return reference.rect().adjusted(-1, -1, 1, 1);
+}
+
+int CanvasOverlay::addReference(const Reference& reference)
+{
+    ReferenceLayer layer;
+    layer.id = m_nextReferenceId++;
+    layer.reference = reference;
+    layer.reference.opacity = qBound(0.0, reference.opacity, 1.0);
+    m_references.append(layer);
+
+    requestReferenceSurface(layer.id);
+    update(referenceDamageRect(reference));
+    return layer.id;
+}
+
+void CanvasOverlay::setReferenceView(int id, const QPointF& position, double scale)
+{
+    ReferenceLayer *layer = findReference(id);
+    if (!layer || (layer->reference.position == position && layer->reference.scale == scale)) return;
+
+    const QRect before = referenceDamageRect(layer->reference);
+    const bool scaleChanged = layer->reference.scale != scale;
+    layer->reference.position = position;
+    layer->reference.scale = scale;
+    if (scaleChanged) {
+        requestReferenceSurface(id);
+    }
+    update(QRegion(before) + referenceDamageRect(layer->reference));
+}
+
+void CanvasOverlay::setReferenceOpacity(int id, double opacity)
+{
+    ReferenceLayer *layer = findReference(id);
+    opacity = qBound(0.0, opacity, 1.0);
+    if (!layer || layer->reference.opacity == opacity) return;
+
+    layer->reference.opacity = opacity;
+    update(layer->reference.rect());
+}
 
-    // 如果图片有效，创建对应的QPixmap
-    if (!state.image.isNull()) {
-        m_displayPixmap = QPixmap::fromImage(state.image);
+void CanvasOverlay::removeReference(int id)
+{
+    for (int i = 0; i < m_references.size(); ++i) {
+        if (m_references.at(i).id == id) {
+            const QRect damage = referenceDamageRect(m_references.at(i).reference);
+            m_references[i].generation.advance();
+            m_references.removeAt(i);
+            pruneMips();
+            update(damage);
+            return;
+        }
     }
+}
 
-    update();
+void CanvasOverlay::clearReferences()
+{
+    QRegion damage;
+    for (ReferenceLayer &layer : m_references) {
+        layer.generation.advance();
+        damage += referenceDamageRect(layer.reference);
+    }
+    m_references.clear();
+    pruneMips();
+    update(damage);
+}
+
+void CanvasOverlay::requestReferenceSurface(int id)
+{
+    ReferenceLayer *layer = findReference(id);
+    if (!layer) return;
+
+    layer->generation.advance();
+    const Reference &reference = layer->reference;
+    if (reference.pixmap.isNull()
+        || !surfaceWorthKeeping(QSizeF(reference.displaySize()) * reference.scale)) {
+        layer->surface = Surface();
+        return;
+    }
+
+    buildSurface(reference.pixmap, reference.orientation, reference.scale,
+                 layer->generation.token(), [this, id](Surface surface) {
+                     if (ReferenceLayer *target = findReference(id)) {
+                         target->surface = std::move(surface);
+                         update(target->reference.rect());
+                     }
+                 });
+}
+
+void CanvasOverlay::setImageOpacity(double opacity)
+{
+    opacity = qBound(0.0, opacity, 1.0);
+    if (opacity == m_displayState.opacity) return;
+
+    m_displayState.opacity = opacity;
+    update(calculateImageRect());
 }
 
 void CanvasOverlay::showEvent(QShowEvent* event)
@@ -211,9 +420,9 @@ void CanvasOverlay::applyX11MousePassthrough()
     if (QGuiApplication::platformName().contains("xcb")) {
         qDebug() << "应用X11鼠标穿透到CanvasOverlay（只穿透非图片区域）";
 
-        Display* display = XOpenDisplay(nullptr);
+        Display* display = X11Display::get();
         if (!display) {
-            qWarning() << "无法打开X11显示连接";
+            qWarning() << "无法获取X11显示连接";
             return;
         }
 
@@ -222,9 +431,8 @@ void CanvasOverlay::applyX11MousePassthrough()
 
         // 获取图片显示区域
         QRect imageRect = QRect(0, 0, 0, 0);
-        if (!m_displayPixmap.isNull()) {
-            imageRect = m_displayPixmap.rect();
-            imageRect.moveCenter(rect().center());
+        if (!m_displayState.pixmap.isNull() && !m_parentWidget.isNull()) {
+            imageRect = calculateImageRect().intersected(rect());
             qDebug() << "图片显示区域:" << imageRect;
         }
 
@@ -291,7 +499,6 @@ void CanvasOverlay::applyX11MousePassthrough()
         }
 
         XFlush(display);
-        XCloseDisplay(display);
 
         qDebug() << "CanvasOverlay X11穿透已应用（智能穿透）";
     } else {
@@ -305,17 +512,11 @@ void CanvasOverlay::forceStayOnTop()
     if (m_parentWidget.isNull()) return;
 
 #ifdef Q_OS_LINUX
-    if (!QGuiApplication::platformName().contains("xcb"))
-        return;
-
-    Display *display = XOpenDisplay(nullptr);
+    Display *display = X11Display::get();
     if (!display) return;
 
     Window window = (Window)winId();
-    if (!window) {
-        XCloseDisplay(display);
-        return;
-    }
+    if (!window) return;
 
     // 1. 获取 _NET_WM_STATE 原子
     Atom net_wm_state = XInternAtom(display, "_NET_WM_STATE", False);
@@ -340,7 +541,6 @@ void CanvasOverlay::forceStayOnTop()
     // 3. 同时提升窗口（传统方式）
     XRaiseWindow(display, window);
     XFlush(display);
-    XCloseDisplay(display);
 
     qDebug() << "CanvasOverlay: 强制置顶成功 (_NET_WM_STATE_ABOVE)";
 #endif
@@ -7,6 +7,11 @@
 #include <QImage>
 #include <QPointF>
 #include <QPointer>
+#include <QTransform>
+#include <QHash>
+#include <QVector>
+#include <functional>
+#include "cancellationtoken.h"
 // 前向声明
 class ImageWidget;
 
@@ -17,12 +22,15 @@ class CanvasOverlay : public QWidget
 public:
     // 定义 DisplayState 结构体
     struct DisplayState {
-        QImage image;
+        QPixmap pixmap;            // 与主窗口隐式共享的原图，不复制像素
+        QTransform orientation;    // 原图 → 方向变换后的坐标（EXIF 方向 + 用户旋转/镜像）
         double scaleFactor = 1.0;
         QPointF panOffset;
-        QRect imageRect;
+        QRect imageRect;           // 主窗口坐标下的显示区域
+        double opacity = 1.0;      // 图片本身的不透明度（与窗口透明度相乘）
 
         DisplayState() : scaleFactor(1.0) {}
+        QSize displaySize() const { return orientation.mapRect(QRectF(pixmap.rect())).toRect().size(); }
     };
 
     explicit CanvasOverlay(ImageWidget* parent = nullptr);
@@ -31,6 +39,33 @@ public:
     void setImage(const QPixmap& pixmap);
     void setDisplayState(const DisplayState& state);
 
+    // 增量更新：像素内容只在换图/换方向时设置一次，视图参数单独更新，
+    // 只重绘旧区域与新区域的并集（参数未变化时不重绘）
+    void setContent(const QPixmap& pixmap, const QTransform& orientation);
+    void setView(double scaleFactor, const QPointF& panOffset, const QRect& imageRect);
+    void setImageOpacity(double opacity);
+    double imageOpacity() const { return m_displayState.opacity; }
+
+    // 参考图板：主图之外同时显示多张参考图，各自有位置、缩放和不透明度。
+    // 像素与主窗口的原图缓存共享（QPixmap 隐式共享），预缩放表面从共用的 mip 链生成，
+    // 每张图的变化只重绘它自己的区域
+    struct Reference {
+        QPixmap pixmap;
+        QTransform orientation;    // 原图 → 方向变换后的坐标
+        QPointF position;          // 左上角（覆盖层坐标）
+        double scale = 1.0;
+        double opacity = 1.0;
+
+        QSize displaySize() const { return orientation.mapRect(QRectF(pixmap.rect())).toRect().size(); }
+        QRect rect() const { return QRectF(position, QSizeF(displaySize()) * scale).toAlignedRect(); }
+    };
+    int addReference(const Reference& reference);   // 返回参考图编号
+    void setReferenceView(int id, const QPointF& position, double scale);
+    void setReferenceOpacity(int id, double opacity);
+    void removeReference(int id);
+    void clearReferences();
+    int referenceCount() const { return m_references.size(); }
+
 protected:
     void paintEvent(QPaintEvent* event) override;
     void showEvent(QShowEvent* event) override;
@@ -38,9 +73,55 @@ protected:
 private:
     void applyX11MousePassthrough();
     QRect calculateImageRect() const;
+    QRect imageDamageRect() const;       // 图片、边框和缩放标注占据的区域
+    static QRect scaleLabelRect(const QRect& imageRect);
+    QRect hintRect() const;              // 底部操作提示（含缩放百分比）
+
+    // 预缩放表面：按（图片, 方向, 缩放）保存一张预乘 ARGB 整图，绘制时直接 1:1 贴图，
+    // 空闲重绘（置顶、遮挡恢复）不做任何缩放。缩放变化时在 CPU 池重建，
+    // 完成前用旧表面拉伸顶替；表面过大时退回与主窗口共用的可见块缓存
+    struct Surface {
+        QImage image;
+        qint64 sourceKey = 0;
+        QTransform orientation;
+        double scale = 0;
+
+        bool sameContent(const QPixmap& pixmap, const QTransform& orient) const
+        {
+            return !image.isNull() && sourceKey == pixmap.cacheKey() && orientation == orient;
+        }
+        bool matches(const QPixmap& pixmap, const QTransform& orient, double s) const
+        {
+            return sameContent(pixmap, orient) && scale == s;
+        }
+    };
+    bool surfaceWorthKeeping(const QSizeF& size) const;
+    void buildSurface(const QPixmap& pixmap, const QTransform& orientation, double scale,
+                      const CancellationToken& token, std::function<void(Surface)> done);
+    void drawSurface(QPainter& painter, const Surface& surface, const QPixmap& pixmap,
+                     const QTransform& orientation, double scale, const QPointF& topLeft) const;
+    void requestSurface();
+    Surface m_surface;
+    GenerationCounter m_surfaceGeneration;
+
+    // 同一张图（按 QPixmap::cacheKey）的 mip 链，由主图和所有参考图共用
+    QHash<qint64, QVector<QImage>> m_mips;
+    void pruneMips();
+
+    // 参考图层
+    struct ReferenceLayer {
+        int id = 0;
+        Reference reference;
+        Surface surface;
+        GenerationCounter generation;
+    };
+    QVector<ReferenceLayer> m_references;
+    int m_nextReferenceId = 1;
+    ReferenceLayer* findReference(int id);
+    static QRect referenceDamageRect(const Reference& reference);
+    void requestReferenceSurface(int id);
 
     // 成员变量
-    QPixmap m_displayPixmap;
     QPointer<ImageWidget> m_parentWidget;  // 改为 QPointer
     DisplayState m_displayState;  // 使用自己的 DisplayState
 
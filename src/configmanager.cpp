@@ -1,9 +1,14 @@
 #include "configmanager.h"
+#include "threadpools.h"
+#include "trace.h"
 #include <QSettings>
-#include <QApplication>
+#include <QCoreApplication>
 #include <QDir>
 #include <QDebug>
 #include <QStandardPaths>
+#include <QSaveFile>
+#include <QTemporaryFile>
+#include <QtConcurrent>
 
 // Config 结构体的默认构造函数
 // ConfigManager::Config::Config() :
@@ -21,7 +26,7 @@ ConfigManager::ConfigManager(const QString& filename)
     QString configDir = QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation);
     if (configDir.isEmpty()) {
         // 如果获取失败，回退到应用程序目录（但 AppImage 下通常是只读的）
-        configDir = QApplication::applicationDirPath();
+        configDir = QCoreApplication::applicationDirPath();
         qWarning() << "Failed to get AppConfigLocation, fallback to app dir:" << configDir;
     } else {
         // 确保目录存在
@@ -32,43 +37,173 @@ ConfigManager::ConfigManager(const QString& filename)
     }
     configPath = configDir + "/" + filename;
     qDebug() << "Config file path:" << configPath;
+
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(kFlushDelayMs);
+    QObject::connect(&m_flushTimer, &QTimer::timeout, &m_flushTimer, [this]() { flushAsync(); });
+}
+
+ConfigManager::~ConfigManager()
+{
+    flush();
+}
+
+bool ConfigManager::Config::operator==(const Config &other) const
+{
+    return windowPosition == other.windowPosition
+           && windowSize == other.windowSize
+           && windowMaximized == other.windowMaximized
+           && transparentBackground == other.transparentBackground
+           && titleBarVisible == other.titleBarVisible
+           && lastOpenPath == other.lastOpenPath
+           && lastViewMode == other.lastViewMode
+           && lastImageIndex == other.lastImageIndex
+           && lastImagePath == other.lastImagePath
+           && sortMode == other.sortMode
+           && sortDescending == other.sortDescending
+           && thumbnailCacheLimitMB == other.thumbnailCacheLimitMB;
 }
 
-// 保存配置到文件
+// 只更新内存并标记为脏，实际写盘合并到 kFlushDelayMs 之后
 bool ConfigManager::saveConfig(const Config& config)
 {
-    QSettings settings(configPath, QSettings::IniFormat);
+    {
+        QMutexLocker locker(&m_mutex);
+        if (config == m_config) {
+            return true;
+        }
+        m_config = config;
+        m_dirty = true;
+    }
+    scheduleFlush();
+    return true;
+}
 
-    // 保存窗口状态
-    settings.beginGroup("Window");
-    settings.setValue("Position", config.windowPosition);
-    settings.setValue("Size", config.windowSize);
-    settings.setValue("Maximized", config.windowMaximized);
-    settings.endGroup();
+void ConfigManager::scheduleFlush()
+{
+    // 每次修改都重新计时：连续操作只在停下来之后写一次
+    m_flushTimer.start();
+}
 
-    // 保存透明背景状态
-    settings.beginGroup("Appearance");
-    settings.setValue("TransparentBackground", config.transparentBackground);
-    settings.setValue("TitleBarVisible", config.titleBarVisible);
-    //settings.setValue("AlwaysOnTop", config.alwaysOnTop);
-    settings.endGroup();
+void ConfigManager::flushAsync()
+{
+    // 上一次写入还没结束：等它结束后再写，保证文件内容按修改顺序落盘
+    if (m_pendingWrite.isRunning()) {
+        scheduleFlush();
+        return;
+    }
 
-    // 保存最近打开路径
-    settings.beginGroup("Recent");
-    settings.setValue("LastOpenPath", config.lastOpenPath);
-    settings.endGroup();
+    Config snapshot;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_dirty) return;
+        snapshot = m_config;
+        m_dirty = false;
+    }
 
+    const QString path = configPath;
+    m_pendingWrite = QtConcurrent::run(ThreadPools::io(), [this, path, snapshot]() {
+        if (!writeConfig(path, snapshot)) {
+            // 下次修改或 flush() 时重试
+            QMutexLocker locker(&m_mutex);
+            m_dirty = true;
+        }
+    });
+}
 
-    // 新增：保存状态信息
-    settings.beginGroup("State");
-    settings.setValue("LastViewMode", config.lastViewMode);
-    settings.setValue("LastImageIndex", config.lastImageIndex);
-    settings.setValue("LastImagePath", config.lastImagePath);
-    settings.endGroup();
+bool ConfigManager::flush()
+{
+    m_flushTimer.stop();
+    m_pendingWrite.waitForFinished();
+
+    Config snapshot;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_dirty) return true;
+        snapshot = m_config;
+        m_dirty = false;
+    }
+    return writeConfig(configPath, snapshot);
+}
+
+bool ConfigManager::writeConfig(const QString &path, const Config &config)
+{
+    PV_TRACE_SCOPE_CAT("writeConfig", "io");
+    // 多个窗口共用同一个配置文件
+    static QMutex writeMutex;
+    QMutexLocker writeLocker(&writeMutex);
+
+    // 先在本地临时目录生成 INI（QSettings 负责编码 QPoint/QSize 等），
+    // 配置目录（可能在网络盘上）只有最后一次整文件写入
+    QTemporaryFile staging;
+    if (!staging.open()) {
+        qWarning() << "无法创建临时配置文件:" << staging.errorString();
+        return false;
+    }
+    staging.close();
+
+    {
+        QSettings settings(staging.fileName(), QSettings::IniFormat);
+
+        // 保存窗口状态
+        settings.beginGroup("Window");
+        settings.setValue("Position", config.windowPosition);
+        settings.setValue("Size", config.windowSize);
+        settings.setValue("Maximized", config.windowMaximized);
+        settings.endGroup();
+
+        // 保存透明背景状态
+        settings.beginGroup("Appearance");
+        settings.setValue("TransparentBackground", config.transparentBackground);
+        settings.setValue("TitleBarVisible", config.titleBarVisible);
+        //settings.setValue("AlwaysOnTop", config.alwaysOnTop);
+        settings.endGroup();
+
+        // 保存最近打开路径
+        settings.beginGroup("Recent");
+        settings.setValue("LastOpenPath", config.lastOpenPath);
+        settings.endGroup();
 
 
-    settings.sync();
-    return (settings.status() == QSettings::NoError);
+        // 新增：保存状态信息
+        settings.beginGroup("State");
+        settings.setValue("LastViewMode", config.lastViewMode);
+        settings.setValue("LastImageIndex", config.lastImageIndex);
+        settings.setValue("LastImagePath", config.lastImagePath);
+        settings.setValue("SortMode", config.sortMode);
+        settings.setValue("SortDescending", config.sortDescending);
+        settings.endGroup();
+
+        settings.beginGroup("Cache");
+        settings.setValue("ThumbnailLimitMB", config.thumbnailCacheLimitMB);
+        settings.endGroup();
+
+
+        settings.sync();
+        if (settings.status() != QSettings::NoError) {
+            qWarning() << "生成配置失败:" << staging.fileName();
+            return false;
+        }
+    }
+
+    QFile staged(staging.fileName());
+    if (!staged.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QByteArray contents = staged.readAll();
+
+    // QSaveFile 写到同目录的临时文件，commit 时原子重命名：中途崩溃不会留下半个配置文件
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "无法写入配置文件:" << path << file.errorString();
+        return false;
+    }
+    file.write(contents);
+    if (!file.commit()) {
+        qWarning() << "写入配置文件失败:" << path << file.errorString();
+        return false;
+    }
+    return true;
 }
 
 // 从文件加载配置
@@ -111,9 +246,18 @@ ConfigManager::Config ConfigManager::loadConfig()
     config.lastViewMode = settings.value("LastViewMode", 0).toInt();
     config.lastImageIndex = settings.value("LastImageIndex", -1).toInt();
     config.lastImagePath = settings.value("LastImagePath", "").toString();
+    config.sortMode = settings.value("SortMode", 0).toInt();
+    config.sortDescending = settings.value("SortDescending", false).toBool();
+    settings.endGroup();
+
+    settings.beginGroup("Cache");
+    config.thumbnailCacheLimitMB = settings.value("ThumbnailLimitMB", config.thumbnailCacheLimitMB).toInt();
     settings.endGroup();
 
     qDebug() << "Config loaded from:" << configPath;
+    QMutexLocker locker(&m_mutex);
+    m_config = config;
+    m_dirty = false;
     return config;
 }
 
@@ -4,7 +4,14 @@
 #include <QString>
 #include <QPoint>
 #include <QSize>
+#include <QTimer>
+#include <QFuture>
+#include <QMutex>
 
+// 配置存储：状态保存在内存里，saveConfig 只比较并标记为脏，
+// 合并一段时间内的多次修改后在 I/O 线程池写盘（先在本地临时文件生成 INI，
+// 再用 QSaveFile 写临时文件并原子重命名），界面线程不再等网络盘上的文件系统。
+// flush() 同步写出尚未落盘的修改，窗口关闭和析构时调用。
 class ConfigManager
 {
 public:
@@ -23,12 +30,19 @@ public:
         int lastViewMode;        // 0=ThumbnailView, 1=SingleView
         int lastImageIndex;      // 最后查看的图片索引
         QString lastImagePath;   // 最后查看的图片路径（备用）
+        int sortMode;            // ImageSorter::SortMode
+        bool sortDescending;     // 是否倒序
 
 
         bool skipMoveToTrashConfirmation = false;   // 是否跳过回收站删除确认
         bool skipPermanentDeleteConfirmation = false; // 是否跳过永久删除确认
+        int thumbnailCacheLimitMB = 512;              // 缩略图磁盘缓存上限
         //Config();       // 默认构造函数
 
+        // 只比较会写入文件的字段
+        bool operator==(const Config &other) const;
+        bool operator!=(const Config &other) const { return !(*this == other); }
+
         Config() :
             windowPosition(100, 100),
             windowSize(800, 600),
@@ -38,24 +52,43 @@ public:
             alwaysOnTop(false),
             lastViewMode(0),          // 默认缩略图模式
             lastImageIndex(-1),       // 无选中图片
-            lastImagePath("")
+            lastImagePath(""),
+            sortMode(0),              // 默认按名称自然排序
+            sortDescending(false)
         {}
     };
 
     ConfigManager(const QString& filename = "viewer_config.ini");
+    ~ConfigManager();   // 写出尚未落盘的修改
 
-    // 保存配置到文件
+    // 更新内存中的配置；有变化时安排延迟写盘（不阻塞调用方）
     bool saveConfig(const Config& config);
 
-    // 从文件加载配置
+    // 从文件加载配置（之后以内存中的为准）
     Config loadConfig();
 
+    // 等待进行中的写入，并同步写出尚未落盘的修改
+    bool flush();
+
     // 获取配置文件路径
     QString getConfigPath() const;
 
 private:
+    // 合并连续修改的等待时间
+    static constexpr int kFlushDelayMs = 500;
+
+    void scheduleFlush();
+    void flushAsync();
+    // 可在任意线程调用；同一进程内的写入串行进行
+    static bool writeConfig(const QString &path, const Config &config);
+
     QString configPath;
 
+    QMutex m_mutex;       // 保护 m_config / m_dirty（写盘任务在后台线程读取）
+    Config m_config;
+    bool m_dirty = false;
+    QTimer m_flushTimer;
+    QFuture<void> m_pendingWrite;
 };
 
 #endif // CONFIGMANAGER_H
@@ -0,0 +1,44 @@
+// directoryscanner.cpp
+#include "directoryscanner.h"
+#include "trace.h"
+#include "formatsniffer.h"
+#include "imagesorter.h"
+#include <QFileInfo>
+
+bool DirectoryScanner::isListable(const QString &absolutePath)
+{
+    FormatSniffer::Format format = FormatSniffer::guess(absolutePath);
+    return FormatSniffer::isImage(format) || FormatSniffer::isArchive(format);
+}
+
+QStringList DirectoryScanner::scan(const QDir &dir, ImageSorter &sorter)
+{
+    PV_TRACE_SCOPE_CAT("directoryScan", "scan");
+    QStringList names;
+    QFileInfoList listableFiles;
+
+    const QFileInfoList fileList = dir.entryInfoList(QDir::Files);
+    for (const QFileInfo &fileInfo : fileList) {
+        if (isListable(fileInfo.absoluteFilePath())) {
+            names.append(fileInfo.fileName());
+            listableFiles.append(fileInfo);
+        }
+    }
+
+    // 排序键（自然排序键、修改时间、大小）每次扫描只计算一次
+    sorter.setFiles(dir.absolutePath(), listableFiles);
+    sorter.sort(names);
+    return names;
+}
+
+QStringList DirectoryScanner::listAbsolutePaths(const QDir &dir)
+{
+    QStringList paths;
+    const QFileInfoList fileList = dir.entryInfoList(QDir::Files | QDir::Readable, QDir::Name);
+    for (const QFileInfo &fileInfo : fileList) {
+        if (isListable(fileInfo.absoluteFilePath())) {
+            paths.append(fileInfo.absoluteFilePath());
+        }
+    }
+    return paths;
+}
@@ -0,0 +1,25 @@
+// directoryscanner.h
+#ifndef DIRECTORYSCANNER_H
+#define DIRECTORYSCANNER_H
+
+#include <QDir>
+#include <QString>
+#include <QStringList>
+
+class ImageSorter;
+
+// 目录扫描：列出可浏览的文件（图片和压缩包，按文件头识别），并按 ImageSorter 当前的
+// 排序方式排序。不依赖任何窗口类，界面、批量生成和性能测试共用同一套扫描逻辑。
+class DirectoryScanner
+{
+public:
+    // absolutePath 是否应该出现在列表中（没有扩展名的文件按文件头识别）
+    static bool isListable(const QString &absolutePath);
+
+    // 返回排好序的文件名（不含目录）；sorter 同时登记这些文件的排序键，供之后的增量更新使用
+    static QStringList scan(const QDir &dir, ImageSorter &sorter);
+    // 不需要排序时只列出文件，按名称顺序返回绝对路径
+    static QStringList listAbsolutePaths(const QDir &dir);
+};
+
+#endif // DIRECTORYSCANNER_H
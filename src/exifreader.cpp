@@ -0,0 +1,168 @@
+// exifreader.cpp
+#include "exifreader.h"
+#include <QFile>
+
+// EXIF 数据位于 APP1 段，段长度上限 64KB
+static const qint64 kExifProbeSize = 64 * 1024;
+
+namespace {
+
+struct TiffCursor {
+    const uchar *data;
+    int size;
+    int base;          // TIFF 头在整个缓冲区中的偏移
+    bool littleEndian;
+
+    bool has(int offset, int length) const {
+        return offset >= 0 && length >= 0 && base + offset + length <= size;
+    }
+    quint16 u16(int offset) const {
+        const uchar *p = data + base + offset;
+        return littleEndian ? quint16(p[0] | (p[1] << 8))
+                            : quint16((p[0] << 8) | p[1]);
+    }
+    quint32 u32(int offset) const {
+        const uchar *p = data + base + offset;
+        return littleEndian ? (quint32(p[0]) | (quint32(p[1]) << 8) |
+                               (quint32(p[2]) << 16) | (quint32(p[3]) << 24))
+                            : ((quint32(p[0]) << 24) | (quint32(p[1]) << 16) |
+                               (quint32(p[2]) << 8) | quint32(p[3]));
+    }
+};
+
+QDateTime parseExifDateTime(const TiffCursor &c, int entryOffset)
+{
+    // ASCII 类型，"YYYY:MM:DD HH:MM:SS\0" 共 20 字节，超过 4 字节存放在偏移处
+    quint32 count = c.u32(entryOffset + 4);
+    if (count < 19) return QDateTime();
+    int valueOffset = int(c.u32(entryOffset + 8));
+    if (!c.has(valueOffset, 19)) return QDateTime();
+
+    QByteArray text(reinterpret_cast<const char *>(c.data + c.base + valueOffset), 19);
+    return QDateTime::fromString(QString::fromLatin1(text), "yyyy:MM:dd HH:mm:ss");
+}
+
+} // namespace
+
+ExifReader::Info ExifReader::read(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return Info();
+    }
+    return readFromData(file.read(kExifProbeSize));
+}
+
+QImageIOHandler::Transformations ExifReader::transformation(int orientation)
+{
+    static const QImageIOHandler::Transformations kTransformations[] = {
+        QImageIOHandler::TransformationNone,
+        QImageIOHandler::TransformationNone,
+        QImageIOHandler::TransformationMirror,
+        QImageIOHandler::TransformationRotate180,
+        QImageIOHandler::TransformationFlip,
+        QImageIOHandler::TransformationFlipAndRotate90,
+        QImageIOHandler::TransformationRotate90,
+        QImageIOHandler::TransformationMirrorAndRotate90,
+        QImageIOHandler::TransformationRotate270,
+    };
+    return kTransformations[qBound(1, orientation, 8)];
+}
+
+ExifReader::Info ExifReader::readFromData(const QByteArray &data)
+{
+    Info info;
+    const uchar *bytes = reinterpret_cast<const uchar *>(data.constData());
+    const int size = int(data.size());
+
+    // TIFF 文件本身就是 EXIF 结构
+    if (size >= 8 && ((bytes[0] == 'I' && bytes[1] == 'I') || (bytes[0] == 'M' && bytes[1] == 'M'))) {
+        parseTiff(data, 0, info);
+        return info;
+    }
+
+    // JPEG：遍历段标记，找到 "Exif\0\0" 开头的 APP1
+    if (size < 4 || bytes[0] != 0xFF || bytes[1] != 0xD8) {
+        return info;
+    }
+
+    int pos = 2;
+    while (pos + 4 <= size) {
+        if (bytes[pos] != 0xFF) break;
+        uchar marker = bytes[pos + 1];
+        if (marker == 0xD8 || (marker >= 0xD0 && marker <= 0xD7) || marker == 0x01) {
+            pos += 2;  // 无长度字段的标记
+            continue;
+        }
+        if (marker == 0xDA || marker == 0xD9) break;  // 图像数据开始，EXIF 不会在后面
+
+        int segmentLength = (bytes[pos + 2] << 8) | bytes[pos + 3];
+        if (segmentLength < 2) break;
+
+        if (marker == 0xE1 && segmentLength >= 8 && pos + 10 <= size &&
+            memcmp(bytes + pos + 4, "Exif\0\0", 6) == 0) {
+            parseTiff(data, pos + 10, info);
+            break;
+        }
+        pos += 2 + segmentLength;
+    }
+
+    return info;
+}
+
+bool ExifReader::parseTiff(const QByteArray &data, int tiffStart, Info &info)
+{
+    TiffCursor c;
+    c.data = reinterpret_cast<const uchar *>(data.constData());
+    c.size = int(data.size());
+    c.base = tiffStart;
+
+    if (!c.has(0, 8)) return false;
+    if (c.data[tiffStart] == 'I' && c.data[tiffStart + 1] == 'I') {
+        c.littleEndian = true;
+    } else if (c.data[tiffStart] == 'M' && c.data[tiffStart + 1] == 'M') {
+        c.littleEndian = false;
+    } else {
+        return false;
+    }
+    if (c.u16(2) != 42) return false;
+
+    QDateTime dateTime;
+    QDateTime dateTimeOriginal;
+    int exifIfdOffset = 0;
+
+    // IFD0：Orientation、DateTime 和 Exif 子 IFD 指针
+    int ifd0 = int(c.u32(4));
+    if (c.has(ifd0, 2)) {
+        int count = c.u16(ifd0);
+        for (int i = 0; i < count; ++i) {
+            int entry = ifd0 + 2 + i * 12;
+            if (!c.has(entry, 12)) break;
+            quint16 tag = c.u16(entry);
+            if (tag == 0x0112) {
+                int orientation = c.u16(entry + 8);
+                if (orientation >= 1 && orientation <= 8) info.orientation = orientation;
+            } else if (tag == 0x0132) {
+                dateTime = parseExifDateTime(c, entry);
+            } else if (tag == 0x8769) {
+                exifIfdOffset = int(c.u32(entry + 8));
+            }
+        }
+    }
+
+    // Exif 子 IFD：DateTimeOriginal（拍摄时间）
+    if (exifIfdOffset > 0 && c.has(exifIfdOffset, 2)) {
+        int count = c.u16(exifIfdOffset);
+        for (int i = 0; i < count; ++i) {
+            int entry = exifIfdOffset + 2 + i * 12;
+            if (!c.has(entry, 12)) break;
+            if (c.u16(entry) == 0x9003) {
+                dateTimeOriginal = parseExifDateTime(c, entry);
+                break;
+            }
+        }
+    }
+
+    info.dateTime = dateTimeOriginal.isValid() ? dateTimeOriginal : dateTime;
+    return true;
+}
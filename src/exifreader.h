@@ -0,0 +1,29 @@
+// exifreader.h
+#ifndef EXIFREADER_H
+#define EXIFREADER_H
+
+#include <QString>
+#include <QByteArray>
+#include <QDateTime>
+#include <QImageIOHandler>
+
+// 轻量 EXIF 读取：只解析文件头部（JPEG APP1 / TIFF IFD），不解码像素
+class ExifReader
+{
+public:
+    struct Info {
+        QDateTime dateTime;   // DateTimeOriginal，没有时取 DateTime
+        int orientation = 1;  // EXIF Orientation (1-8)，1 表示无需变换
+    };
+
+    // 只读取文件前 64KB
+    static Info read(const QString &filePath);
+    static Info readFromData(const QByteArray &data);
+    // EXIF Orientation (1-8) → QImageIOHandler 的变换标志
+    static QImageIOHandler::Transformations transformation(int orientation);
+
+private:
+    static bool parseTiff(const QByteArray &data, int tiffStart, Info &info);
+};
+
+#endif // EXIFREADER_H
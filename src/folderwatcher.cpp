@@ -0,0 +1,239 @@
+// folderwatcher.cpp
+#include "folderwatcher.h"
+#include "logging.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QSocketNotifier>
+#include <QDebug>
+
+#ifdef Q_OS_LINUX
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
+// 合并事件的时间窗口（毫秒），相机连拍/渲染农场批量落盘时避免逐个刷新
+static const int kFlushDelayMs = 100;
+
+FolderWatcher::FolderWatcher(QObject *parent)
+    : QObject(parent),
+    m_inotifyFd(-1),
+    m_watchDescriptor(-1),
+    m_notifier(nullptr),
+    m_fallbackWatcher(nullptr),
+    m_rescanPending(false)
+{
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(kFlushDelayMs);
+    connect(&m_flushTimer, &QTimer::timeout, this, &FolderWatcher::flushPendingEvents);
+
+#ifdef Q_OS_LINUX
+    m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotifyFd >= 0) {
+        m_notifier = new QSocketNotifier(m_inotifyFd, QSocketNotifier::Read, this);
+        connect(m_notifier, &QSocketNotifier::activated, this, &FolderWatcher::readInotifyEvents);
+    } else {
+        qWarning() << "inotify 初始化失败，回退到 QFileSystemWatcher";
+    }
+#endif
+}
+
+FolderWatcher::~FolderWatcher()
+{
+    stop();
+#ifdef Q_OS_LINUX
+    if (m_inotifyFd >= 0) {
+        ::close(m_inotifyFd);
+        m_inotifyFd = -1;
+    }
+#endif
+}
+
+bool FolderWatcher::watch(const QString &dirPath)
+{
+    QString absPath = QDir(dirPath).absolutePath();
+    if (absPath == m_watchedPath) return true;
+
+    stop();
+
+    if (!QFileInfo(absPath).isDir()) return false;
+
+#ifdef Q_OS_LINUX
+    if (m_inotifyFd >= 0) {
+        // IN_CLOSE_WRITE 而不是 IN_CREATE：文件写完才通知，避免缩略图读到半个文件
+        const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO |
+                              IN_DELETE | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+        m_watchDescriptor = inotify_add_watch(m_inotifyFd, QFile::encodeName(absPath).constData(), mask);
+        if (m_watchDescriptor >= 0) {
+            m_watchedPath = absPath;
+            qCDebug(lcScan) << "inotify 开始监视目录:" << absPath;
+            return true;
+        }
+        qWarning() << "inotify_add_watch 失败:" << absPath;
+    }
+#endif
+
+    // 回退方案：QFileSystemWatcher 只通知目录变化，需要自行比较差异
+    if (!m_fallbackWatcher) {
+        m_fallbackWatcher = new QFileSystemWatcher(this);
+        connect(m_fallbackWatcher, &QFileSystemWatcher::directoryChanged,
+                this, &FolderWatcher::onFallbackDirectoryChanged);
+    }
+    const QStringList entries = QDir(absPath).entryList(QDir::Files);
+    m_knownFiles = QSet<QString>(entries.begin(), entries.end());
+    if (!m_fallbackWatcher->addPath(absPath)) {
+        m_knownFiles.clear();
+        return false;
+    }
+    m_watchedPath = absPath;
+    return true;
+}
+
+void FolderWatcher::stop()
+{
+#ifdef Q_OS_LINUX
+    if (m_inotifyFd >= 0 && m_watchDescriptor >= 0) {
+        inotify_rm_watch(m_inotifyFd, m_watchDescriptor);
+    }
+    m_watchDescriptor = -1;
+#endif
+    if (m_fallbackWatcher && !m_fallbackWatcher->directories().isEmpty()) {
+        m_fallbackWatcher->removePaths(m_fallbackWatcher->directories());
+    }
+    m_knownFiles.clear();
+
+    m_flushTimer.stop();
+    m_pendingWritten.clear();
+    m_pendingRemoved.clear();
+    m_pendingRenames.clear();
+    m_pendingMoveFrom.clear();
+    m_rescanPending = false;
+    m_watchedPath.clear();
+}
+
+void FolderWatcher::readInotifyEvents()
+{
+#ifdef Q_OS_LINUX
+    alignas(struct inotify_event) char buffer[64 * 1024];
+
+    for (;;) {
+        ssize_t length = ::read(m_inotifyFd, buffer, sizeof(buffer));
+        if (length <= 0) break;  // 非阻塞模式下读空返回 EAGAIN
+
+        for (char *ptr = buffer; ptr < buffer + length; ) {
+            const struct inotify_event *event = reinterpret_cast<const struct inotify_event *>(ptr);
+            ptr += sizeof(struct inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                m_rescanPending = true;
+                continue;
+            }
+            // 旧的监视描述符残留事件（切换目录之后）直接丢弃
+            if (event->wd != m_watchDescriptor) continue;
+
+            if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) {
+                m_rescanPending = true;
+                continue;
+            }
+            if (event->len == 0 || (event->mask & IN_ISDIR)) continue;
+
+            const QString name = QFile::decodeName(event->name);
+
+            if (event->mask & IN_CLOSE_WRITE) {
+                noteWritten(name);
+            } else if (event->mask & IN_DELETE) {
+                noteRemoved(name);
+            } else if (event->mask & IN_MOVED_FROM) {
+                m_pendingMoveFrom.insert(event->cookie, name);
+            } else if (event->mask & IN_MOVED_TO) {
+                auto it = m_pendingMoveFrom.find(event->cookie);
+                if (it != m_pendingMoveFrom.end()) {
+                    const QString oldName = it.value();
+                    m_pendingRenames.append(qMakePair(oldName, name));
+                    m_pendingMoveFrom.erase(it);
+                    // 先写临时名再改名（联机拍摄、渲染输出常见）：写入事件跟着文件走到新名字，
+                    // 否则刷新时会按旧名字插入一个并不存在的文件
+                    if (m_pendingWritten.remove(oldName)) {
+                        noteWritten(name);
+                    }
+                } else {
+                    // 从其他目录移入，视为新文件
+                    noteWritten(name);
+                }
+            }
+        }
+    }
+
+    scheduleFlush();
+#endif
+}
+
+void FolderWatcher::onFallbackDirectoryChanged(const QString &path)
+{
+    if (path != m_watchedPath) return;
+
+    const QStringList entries = QDir(path).entryList(QDir::Files);
+    QSet<QString> current(entries.begin(), entries.end());
+
+    for (const QString &name : std::as_const(m_knownFiles)) {
+        if (!current.contains(name)) noteRemoved(name);
+    }
+    for (const QString &name : std::as_const(current)) {
+        if (!m_knownFiles.contains(name)) noteWritten(name);
+    }
+    m_knownFiles = current;
+
+    scheduleFlush();
+}
+
+void FolderWatcher::noteWritten(const QString &name)
+{
+    m_pendingRemoved.remove(name);
+    m_pendingWritten.insert(name);
+}
+
+void FolderWatcher::noteRemoved(const QString &name)
+{
+    m_pendingWritten.remove(name);
+    m_pendingRemoved.insert(name);
+}
+
+void FolderWatcher::scheduleFlush()
+{
+    if (!m_flushTimer.isActive()) {
+        m_flushTimer.start();
+    }
+}
+
+void FolderWatcher::flushPendingEvents()
+{
+    if (m_rescanPending) {
+        // 溢出或目录本身被移走后增量信息不可靠：丢弃并停止监视，
+        // 接收方完整扫描时会重新调用 watch()
+        stop();
+        emit rescanRequired();
+        return;
+    }
+
+    // 只有 MOVED_FROM 没有配对的 MOVED_TO：文件被移出目录
+    for (const QString &name : std::as_const(m_pendingMoveFrom)) {
+        noteRemoved(name);
+    }
+    m_pendingMoveFrom.clear();
+
+    // 接收方按排序位置逐个插入，顺序无关
+    const QStringList removed(m_pendingRemoved.cbegin(), m_pendingRemoved.cend());
+    const QList<QPair<QString, QString>> renames = m_pendingRenames;
+    const QStringList written(m_pendingWritten.cbegin(), m_pendingWritten.cend());
+    m_pendingRemoved.clear();
+    m_pendingRenames.clear();
+    m_pendingWritten.clear();
+
+    if (!removed.isEmpty()) emit filesRemoved(removed);
+    for (const auto &rename : renames) {
+        emit fileRenamed(rename.first, rename.second);
+    }
+    if (!written.isEmpty()) emit filesWritten(written);
+}
@@ -0,0 +1,73 @@
+// folderwatcher.h
+#ifndef FOLDERWATCHER_H
+#define FOLDERWATCHER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QSet>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QTimer>
+
+class QSocketNotifier;
+class QFileSystemWatcher;
+
+// 目录实时监视：Linux 下直接使用 inotify（大目录下 QFileSystemWatcher 只能告诉我们“目录变了”，
+// 需要整目录重新扫描），其他平台回退到 QFileSystemWatcher + 差异比较。
+// 事件会在短时间窗口内合并后以增量形式发出。
+class FolderWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FolderWatcher(QObject *parent = nullptr);
+    ~FolderWatcher();
+
+    // 开始监视目录（会自动停止之前的监视）
+    bool watch(const QString &dirPath);
+    void stop();
+
+    QString watchedPath() const { return m_watchedPath; }
+    bool isWatching() const { return !m_watchedPath.isEmpty(); }
+
+signals:
+    // 新文件写入完成或已有文件被修改（由接收方根据列表判断是新增还是修改）
+    void filesWritten(const QStringList &fileNames);
+    void filesRemoved(const QStringList &fileNames);
+    void fileRenamed(const QString &oldName, const QString &newName);
+    // 事件队列溢出或目录本身消失，需要完整重新扫描
+    void rescanRequired();
+
+private slots:
+    void readInotifyEvents();
+    void onFallbackDirectoryChanged(const QString &path);
+    void flushPendingEvents();
+
+private:
+    void noteWritten(const QString &name);
+    void noteRemoved(const QString &name);
+    void scheduleFlush();
+
+    QString m_watchedPath;
+
+    // inotify
+    int m_inotifyFd;
+    int m_watchDescriptor;
+    QSocketNotifier *m_notifier;
+
+    // 非 Linux 回退方案
+    QFileSystemWatcher *m_fallbackWatcher;
+    QSet<QString> m_knownFiles;
+
+    // 待合并的事件（突发时一个窗口内可能有上万个文件，用集合去重）
+    QSet<QString> m_pendingWritten;
+    QSet<QString> m_pendingRemoved;
+    QList<QPair<QString, QString>> m_pendingRenames;
+    QHash<quint32, QString> m_pendingMoveFrom;   // cookie -> 旧文件名
+    bool m_rescanPending;
+    QTimer m_flushTimer;
+};
+
+#endif // FOLDERWATCHER_H
@@ -0,0 +1,212 @@
+// formatsniffer.cpp
+#include "formatsniffer.h"
+#include "logging.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QDebug>
+#include <cstring>
+
+namespace {
+
+struct SniffEntry {
+    FormatSniffer::Format format = FormatSniffer::Unknown;
+    bool sniffed = false;        // 是否已经读取过文件头
+    bool decodeFailed = false;
+    // 失败时文件的修改时间和大小：不一致说明文件已被替换，失败记录作废
+    qint64 failedMtime = 0;
+    qint64 failedSize = -1;
+};
+
+// 缩略图线程和 GUI 线程共用
+QHash<QString, SniffEntry> s_cache;
+QMutex s_cacheMutex;
+
+// 条目上限：长时间浏览很多目录时不无限增长。超出时整体清空，
+// 丢掉的只是可以重新得到的文件头识别结果和失败记录
+const int kMaxCacheEntries = 100000;
+
+// 调用方持有 s_cacheMutex
+SniffEntry &cacheEntry(const QString &filePath)
+{
+    if (s_cache.size() >= kMaxCacheEntries && !s_cache.contains(filePath)) {
+        s_cache.clear();
+    }
+    return s_cache[filePath];
+}
+
+// 压缩包条目（"压缩包路径|内部路径"）按压缩包本身判断是否修改
+QFileInfo sourceInfo(const QString &filePath)
+{
+    const int separator = filePath.indexOf('|');
+    return QFileInfo(separator >= 0 ? filePath.left(separator) : filePath);
+}
+
+bool startsWith(const QByteArray &data, int offset, const char *magic, int length)
+{
+    return data.size() >= offset + length &&
+           memcmp(data.constData() + offset, magic, length) == 0;
+}
+
+} // namespace
+
+FormatSniffer::Format FormatSniffer::fromHeader(const QByteArray &header)
+{
+    // 图片
+    if (startsWith(header, 0, "\x89PNG\r\n\x1a\n", 8)) return Png;
+    if (startsWith(header, 0, "\xff\xd8\xff", 3)) return Jpeg;
+    if (startsWith(header, 0, "GIF87a", 6) || startsWith(header, 0, "GIF89a", 6)) return Gif;
+    if (startsWith(header, 0, "RIFF", 4) && startsWith(header, 8, "WEBP", 4)) return WebP;
+    if (startsWith(header, 0, "II*\0", 4) || startsWith(header, 0, "MM\0*", 4)) return Tiff;
+    // "BM" 只有两个字节，额外检查保留字段为 0 以减少误判
+    if (startsWith(header, 0, "BM", 2) && header.size() >= 10 &&
+        header.at(6) == 0 && header.at(7) == 0 && header.at(8) == 0 && header.at(9) == 0) {
+        return Bmp;
+    }
+
+    // 压缩包
+    if (startsWith(header, 0, "PK\x03\x04", 4) || startsWith(header, 0, "PK\x05\x06", 4) ||
+        startsWith(header, 0, "PK\x07\x08", 4)) {
+        return Zip;
+    }
+    if (startsWith(header, 0, "Rar!\x1a\x07", 6)) return Rar;
+    if (startsWith(header, 0, "7z\xbc\xaf\x27\x1c", 6)) return SevenZip;
+    if (startsWith(header, 0, "\x1f\x8b", 2)) return Gzip;
+    if (startsWith(header, 0, "BZh", 3)) return Bzip2;
+    if (startsWith(header, 0, "\xfd" "7zXZ\0", 6)) return Xz;
+
+    return Unknown;
+}
+
+FormatSniffer::Format FormatSniffer::fromFileName(const QString &fileName)
+{
+    static const QHash<QString, Format> suffixes = {
+        {"png", Png},  {"jpg", Jpeg}, {"jpeg", Jpeg}, {"gif", Gif},
+        {"bmp", Bmp},  {"webp", WebP}, {"tiff", Tiff}, {"tif", Tiff},
+        {"zip", Zip},  {"rar", Rar},  {"7z", SevenZip}, {"gz", Gzip},
+        {"bz2", Bzip2}, {"xz", Xz},   {"tar", Tar}
+    };
+
+    int dot = fileName.lastIndexOf('.');
+    if (dot < 0 || dot == fileName.size() - 1) return Unknown;
+    return suffixes.value(fileName.mid(dot + 1).toLower(), Unknown);
+}
+
+FormatSniffer::Format FormatSniffer::detect(const QString &filePath)
+{
+    {
+        QMutexLocker locker(&s_cacheMutex);
+        auto it = s_cache.constFind(filePath);
+        if (it != s_cache.constEnd() && it->sniffed) {
+            return it->format;
+        }
+    }
+
+    QByteArray header;
+    QFile file(filePath);
+    if (file.open(QIODevice::ReadOnly)) {
+        header = file.read(kHeaderSize);
+    }
+
+    Format format = fromHeader(header);
+    if (format == Unknown) {
+        // 魔数未识别（tar 或读取失败），退回扩展名
+        format = fromFileName(filePath);
+    }
+
+    QMutexLocker locker(&s_cacheMutex);
+    SniffEntry &entry = cacheEntry(filePath);
+    entry.format = format;
+    entry.sniffed = true;
+    return format;
+}
+
+FormatSniffer::Format FormatSniffer::guess(const QString &filePath)
+{
+    {
+        QMutexLocker locker(&s_cacheMutex);
+        auto it = s_cache.constFind(filePath);
+        if (it != s_cache.constEnd() && it->sniffed) {
+            return it->format;
+        }
+    }
+
+    // 扩展名已知的文件不读文件头：列出上万个文件时避免额外的 I/O，
+    // 真正的格式在解码时由 detect() 确认
+    Format format = fromFileName(filePath);
+    if (format != Unknown) return format;
+
+    // 有扩展名但不认识（RAW、.xmp 边车文件、视频等）：不读文件头。
+    // RAW 以 TIFF 魔数开头，按文件头识别会被当成 TIFF 列出来，在 RAW+JPEG 目录里重复且无法解码
+    const QString fileName = QFileInfo(filePath).fileName();
+    const int dot = fileName.lastIndexOf('.');
+    if (dot > 0 && dot < fileName.size() - 1) return Unknown;
+
+    // 没有扩展名（例如浏览器缓存、相机导出的无后缀文件）：读文件头识别
+    return detect(filePath);
+}
+
+QByteArray FormatSniffer::decoderFormat(Format format)
+{
+    switch (format) {
+    case Png:  return "png";
+    case Jpeg: return "jpeg";
+    case Gif:  return "gif";
+    case Bmp:  return "bmp";
+    case WebP: return "webp";
+    case Tiff: return "tiff";
+    default:   return QByteArray();
+    }
+}
+
+bool FormatSniffer::hasDecodeFailed(const QString &filePath)
+{
+    qint64 failedMtime = 0;
+    qint64 failedSize = -1;
+    {
+        QMutexLocker locker(&s_cacheMutex);
+        auto it = s_cache.constFind(filePath);
+        if (it == s_cache.constEnd() || !it->decodeFailed) return false;
+        failedMtime = it->failedMtime;
+        failedSize = it->failedSize;
+    }
+
+    // 目录监视可能漏掉修改（网络盘、压缩包模式下监视暂停），这里再按修改时间和大小核对一次
+    const QFileInfo info = sourceInfo(filePath);
+    if (info.exists() && info.lastModified().toMSecsSinceEpoch() == failedMtime && info.size() == failedSize) {
+        return true;
+    }
+
+    QMutexLocker locker(&s_cacheMutex);
+    s_cache.remove(filePath);
+    qCDebug(lcDecode) << "文件已修改，清除解码失败记录:" << filePath;
+    return false;
+}
+
+void FormatSniffer::markDecodeFailed(const QString &filePath)
+{
+    const QFileInfo info = sourceInfo(filePath);
+    const qint64 mtime = info.lastModified().toMSecsSinceEpoch();
+    const qint64 size = info.size();
+
+    QMutexLocker locker(&s_cacheMutex);
+    SniffEntry &entry = cacheEntry(filePath);
+    entry.decodeFailed = true;
+    entry.failedMtime = mtime;
+    entry.failedSize = size;
+    qCDebug(lcDecode) << "记录解码失败，文件未修改前不再重试:" << filePath;
+}
+
+void FormatSniffer::invalidate(const QString &filePath)
+{
+    QMutexLocker locker(&s_cacheMutex);
+    s_cache.remove(filePath);
+}
+
+void FormatSniffer::clearCache()
+{
+    QMutexLocker locker(&s_cacheMutex);
+    s_cache.clear();
+}
@@ -0,0 +1,62 @@
+// formatsniffer.h
+#ifndef FORMATSNIFFER_H
+#define FORMATSNIFFER_H
+
+#include <QString>
+#include <QByteArray>
+
+// 文件类型识别：读取文件前 32 字节按魔数判断格式，扩展名只作为后备。
+// 所有"是不是图片/压缩包"的判断都集中在这里，结果按路径缓存；
+// 解码失败的文件也记录下来，同一个坏文件只会解码失败一次。
+class FormatSniffer
+{
+public:
+    enum Format {
+        Unknown = 0,
+        // 图片
+        Png,
+        Jpeg,
+        Gif,
+        Bmp,
+        WebP,
+        Tiff,
+        // 压缩包
+        Zip,
+        Rar,
+        SevenZip,
+        Gzip,
+        Bzip2,
+        Xz,
+        Tar          // tar 没有位于文件头的魔数，只能靠扩展名
+    };
+
+    static const int kHeaderSize = 32;
+
+    // 按魔数判断（header 至少包含文件开头的若干字节）
+    static Format fromHeader(const QByteArray &header);
+    // 按扩展名判断
+    static Format fromFileName(const QString &fileName);
+
+    // 读取文件头判断格式（结果缓存）；魔数无法识别时退回扩展名
+    static Format detect(const QString &filePath);
+    // 低开销判断：已缓存的结果 > 已知扩展名 > 读取文件头（只对没有扩展名的文件）。用于列目录和绘制
+    static Format guess(const QString &filePath);
+
+    static bool isImage(Format format) { return format >= Png && format <= Tiff; }
+    static bool isArchive(Format format) { return format >= Zip; }
+    static bool isImageFile(const QString &filePath) { return isImage(guess(filePath)); }
+    static bool isArchiveFile(const QString &filePath) { return isArchive(guess(filePath)); }
+
+    // 传给 QImageReader 的格式名，直接使用对应的解码插件，不再逐个尝试
+    static QByteArray decoderFormat(Format format);
+
+    // 解码失败记录：按失败时的修改时间和大小记录，文件变化后自动失效
+    static bool hasDecodeFailed(const QString &filePath);
+    static void markDecodeFailed(const QString &filePath);
+
+    // 文件被修改/删除/重命名后清除该路径的缓存
+    static void invalidate(const QString &filePath);
+    static void clearCache();
+};
+
+#endif // FORMATSNIFFER_H
@@ -0,0 +1,85 @@
+// imagerendercache.cpp
+#include "imagerendercache.h"
+#include "trace.h"
+#include <QPainter>
+
+void ImageRenderCache::draw(QPainter &painter, const QPixmap &source, const QTransform &view,
+                            double scale, const QRect &window)
+{
+    if (source.isNull() || scale <= 0) return;
+
+    const QRect sourceRect = view.inverted().mapRect(QRectF(window))
+                                 .toAlignedRect().intersected(source.rect());
+    const QSize targetSize = (QSizeF(sourceRect.size()) * scale).toSize();
+    if (sourceRect.isEmpty() || targetSize.isEmpty()) return;
+
+    // 在原图方向上平滑缩放可见块，再按方向贴到窗口：
+    // 旋转都是 90° 的倍数，缩放后已是 1:1，不再有插值损失
+    const QPixmap scaled = piece(source, sourceRect, targetSize);
+    painter.save();
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    painter.setTransform(view, true);
+    painter.drawPixmap(QRectF(sourceRect), scaled, QRectF(scaled.rect()));
+    painter.restore();
+}
+
+void ImageRenderCache::clear()
+{
+    m_sourceKey = 0;
+    m_sourceRect = QRect();
+    m_targetSize = QSize();
+    m_piece = QPixmap();
+}
+
+QImage ImageRenderCache::prescaled(const QImage &source, const QTransform &orientation, double scale)
+{
+    PV_TRACE_SCOPE_CAT("prescale", "paint");
+    if (source.isNull() || scale <= 0) return QImage();
+
+    // 先在原图方向上缩放（平滑缩放做面积平均），再做 90° 倍数的方向变换，不再插值
+    const QSize scaledSize = (QSizeF(source.size()) * scale).toSize().expandedTo(QSize(1, 1));
+    QImage result = source.scaled(scaledSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    const QTransform rotation(orientation.m11(), orientation.m12(), orientation.m21(), orientation.m22(), 0, 0);
+    if (!rotation.isIdentity()) {
+        result = result.transformed(rotation);
+    }
+    return result.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+}
+
+QVector<QImage> ImageRenderCache::mipChain(const QImage &source, int minSide)
+{
+    PV_TRACE_SCOPE_CAT("mipChain", "paint");
+    QVector<QImage> mips;
+    QImage level = source;
+    while (qMax(level.width(), level.height()) / 2 >= minSide) {
+        level = level.scaled(level.width() / 2, level.height() / 2, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        mips.append(level);
+    }
+    return mips;
+}
+
+QImage ImageRenderCache::mipFor(const QImage &source, const QVector<QImage> &mips, double scale)
+{
+    const double targetWidth = source.width() * scale;
+    QImage best = source;
+    for (const QImage &mip : mips) {
+        if (mip.width() < targetWidth) break;
+        best = mip;
+    }
+    return best;
+}
+
+QPixmap ImageRenderCache::piece(const QPixmap &source, const QRect &sourceRect, const QSize &targetSize)
+{
+    if (m_sourceKey == source.cacheKey() && m_sourceRect == sourceRect && m_targetSize == targetSize) {
+        return m_piece;
+    }
+
+    PV_TRACE_SCOPE_CAT("scalePiece", "paint");
+    m_piece = (sourceRect == source.rect() ? source : source.copy(sourceRect))
+                  .scaled(targetSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    m_sourceKey = source.cacheKey();
+    m_sourceRect = sourceRect;
+    m_targetSize = targetSize;
+    return m_piece;
+}
@@ -0,0 +1,43 @@
+// imagerendercache.h
+#ifndef IMAGERENDERCACHE_H
+#define IMAGERENDERCACHE_H
+
+#include <QImage>
+#include <QPixmap>
+#include <QRect>
+#include <QTransform>
+#include <QVector>
+
+class QPainter;
+
+// 按需渲染：只把窗口内可见的那一块原图平滑缩放到屏幕尺寸，再按方向变换贴到窗口。
+// 缩放结果按（原图, 可见块, 目标尺寸）缓存一份，参数不变的重绘（悬停提示、置顶、覆盖层刷新）
+// 直接复用。主窗口和画布覆盖层共用同一个实例，进入画布模式时不必重新缩放。
+class ImageRenderCache
+{
+public:
+    // view 为原图 → 窗口的完整变换，scale 为其中的缩放倍数；window 为窗口坐标下需要绘制的区域
+    void draw(QPainter &painter, const QPixmap &source, const QTransform &view, double scale, const QRect &window);
+
+    void clear();
+
+    // 整图预缩放：按方向变换并平滑缩放为预乘 ARGB，绘制时 1:1 贴图即可。
+    // 只用 QImage，可在工作线程调用
+    static QImage prescaled(const QImage &source, const QTransform &orientation, double scale);
+
+    // mip 链：第 i 项为原图的 1/2^(i+1)，逐级平滑减半，长边小于 minSide 的一级不再生成。
+    // 同一张图在不同缩放下预缩放时从不小于目标的最小一级开始，只做一次小幅缩放
+    static QVector<QImage> mipChain(const QImage &source, int minSide = 256);
+    // 从 source（第 0 级）和 mips 中选出缩放到 scale 时不小于目标尺寸的最小一级
+    static QImage mipFor(const QImage &source, const QVector<QImage> &mips, double scale);
+
+private:
+    QPixmap piece(const QPixmap &source, const QRect &sourceRect, const QSize &targetSize);
+
+    qint64 m_sourceKey = 0;
+    QRect m_sourceRect;
+    QSize m_targetSize;
+    QPixmap m_piece;
+};
+
+#endif // IMAGERENDERCACHE_H
@@ -0,0 +1,264 @@
+// imagesorter.cpp
+#include "imagesorter.h"
+#include "logging.h"
+#include "trace.h"
+#include "exifreader.h"
+#include <QCollator>
+#include <QDir>
+#include <QLocale>
+#include <QtConcurrent>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <algorithm>
+
+// 数字段补零后的宽度（覆盖 64 位整数的位数）
+static const int kDigitRunWidth = 20;
+// 每个并行任务处理的条目数，任务内共用一个 QCollator
+static const int kKeyChunkSize = 256;
+
+static QCollator createCollator()
+{
+    QCollator collator{QLocale()};
+    collator.setCaseSensitivity(Qt::CaseInsensitive);
+    // 不依赖 setNumericMode：部分平台的后端不支持，数字段由 naturalSortString 处理
+    return collator;
+}
+
+ImageSorter::ImageSorter()
+    : m_mode(SortByName),
+    m_descending(false),
+    m_hasFileInfo(false)
+{
+}
+
+void ImageSorter::setMode(SortMode mode, bool descending)
+{
+    m_mode = mode;
+    m_descending = descending;
+}
+
+QString ImageSorter::naturalSortString(const QString &name)
+{
+    QString result;
+    result.reserve(name.size() + kDigitRunWidth);
+
+    const int length = int(name.size());
+    int i = 0;
+    while (i < length) {
+        if (!name.at(i).isDigit()) {
+            result.append(name.at(i));
+            ++i;
+            continue;
+        }
+
+        // 一段连续数字：去掉前导零后左侧补零，使字符串比较等价于数值比较
+        int start = i;
+        while (i < length && name.at(i).isDigit()) ++i;
+        int significant = start;
+        while (significant < i - 1 && name.at(significant) == QLatin1Char('0')) ++significant;
+
+        int digits = i - significant;
+        if (digits < kDigitRunWidth) {
+            result.append(QString(kDigitRunWidth - digits, QLatin1Char('0')));
+        }
+        result.append(QStringView(name).mid(significant, digits));
+    }
+    return result;
+}
+
+void ImageSorter::computeNameKeys(const QList<QPair<QString, Entry *>> &pending)
+{
+    if (pending.isEmpty()) return;
+
+    QList<QPair<int, int>> chunks;
+    for (int start = 0; start < pending.size(); start += kKeyChunkSize) {
+        chunks.append(qMakePair(start, qMin(start + kKeyChunkSize, int(pending.size()))));
+    }
+
+    auto computeChunk = [&pending](const QPair<int, int> &range) {
+        QCollator collator = createCollator();
+        for (int i = range.first; i < range.second; ++i) {
+            pending[i].second->nameKey = collator.sortKey(naturalSortString(pending[i].first));
+        }
+    };
+
+    if (chunks.size() == 1) {
+        computeChunk(chunks.first());
+    } else {
+        QtConcurrent::blockingMap(chunks, computeChunk);
+    }
+}
+
+void ImageSorter::setFiles(const QString &dirPath, const QFileInfoList &files)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    m_entries.clear();
+    m_entries.reserve(files.size());
+    m_dirPath = dirPath;
+    m_hasFileInfo = true;
+
+    for (const QFileInfo &fileInfo : files) {
+        Entry &entry = m_entries[fileInfo.fileName()];
+        entry.modifiedTime = fileInfo.lastModified().toMSecsSinceEpoch();
+        entry.size = fileInfo.size();
+        entry.exifTime = entry.modifiedTime;
+    }
+
+    // 先插入完再取指针，避免哈希表扩容导致指针失效
+    QList<QPair<QString, Entry *>> pending;
+    pending.reserve(m_entries.size());
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+        pending.append(qMakePair(it.key(), &it.value()));
+    }
+    computeNameKeys(pending);
+
+    qCDebug(lcScan) << "排序键计算完成:" << m_entries.size() << "个，耗时" << timer.elapsed() << "ms";
+}
+
+void ImageSorter::setNames(const QStringList &names)
+{
+    m_entries.clear();
+    m_entries.reserve(names.size());
+    m_dirPath.clear();
+    m_hasFileInfo = false;
+
+    for (const QString &name : names) {
+        m_entries[name];
+    }
+
+    QList<QPair<QString, Entry *>> pending;
+    pending.reserve(m_entries.size());
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+        pending.append(qMakePair(it.key(), &it.value()));
+    }
+    computeNameKeys(pending);
+}
+
+void ImageSorter::clear()
+{
+    m_entries.clear();
+    m_dirPath.clear();
+    m_hasFileInfo = false;
+}
+
+void ImageSorter::addFile(const QFileInfo &fileInfo)
+{
+    Entry entry;
+    entry.modifiedTime = fileInfo.lastModified().toMSecsSinceEpoch();
+    entry.size = fileInfo.size();
+    entry.exifTime = entry.modifiedTime;
+    entry.nameKey = createCollator().sortKey(naturalSortString(fileInfo.fileName()));
+    m_entries.insert(fileInfo.fileName(), entry);
+}
+
+void ImageSorter::removeFile(const QString &fileName)
+{
+    m_entries.remove(fileName);
+}
+
+QList<QPair<QString, QString>> ImageSorter::pendingExifFiles() const
+{
+    QList<QPair<QString, QString>> files;
+    if (!m_hasFileInfo) return files;
+
+    QDir dir(m_dirPath);
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        if (!it.value().exifLoaded) {
+            files.append(qMakePair(it.key(), dir.absoluteFilePath(it.key())));
+        }
+    }
+    return files;
+}
+
+QHash<QString, qint64> ImageSorter::readExifTimes(const QList<QPair<QString, QString>> &files,
+                                                  const CancellationToken &token)
+{
+    PV_TRACE_SCOPE_CAT("readExifTimes", "scan");
+    QElapsedTimer timer;
+    timer.start();
+
+    QHash<QString, qint64> times;
+    times.reserve(files.size());
+    for (const auto &file : files) {
+        if (token.isCancelled()) return {};
+        ExifReader::Info info = ExifReader::read(file.second);
+        times.insert(file.first, info.dateTime.isValid() ? info.dateTime.toMSecsSinceEpoch() : 0);
+    }
+
+    qCDebug(lcScan) << "EXIF 日期读取完成:" << times.size() << "个，耗时" << timer.elapsed() << "ms";
+    return times;
+}
+
+void ImageSorter::setExifTimes(const QHash<QString, qint64> &times)
+{
+    for (auto it = times.constBegin(); it != times.constEnd(); ++it) {
+        auto entry = m_entries.find(it.key());
+        if (entry == m_entries.end() || entry.value().exifLoaded) continue;
+        entry.value().exifTime = it.value() > 0 ? it.value() : entry.value().modifiedTime;
+        entry.value().exifLoaded = true;
+    }
+}
+
+int ImageSorter::compareEntries(const QString &a, const Entry &ea, const QString &b, const Entry &eb) const
+{
+    int result = 0;
+    if (m_hasFileInfo) {
+        qint64 ka = 0, kb = 0;
+        switch (m_mode) {
+        case SortByModifiedTime: ka = ea.modifiedTime; kb = eb.modifiedTime; break;
+        case SortBySize:         ka = ea.size;         kb = eb.size;         break;
+        case SortByExifDate:     ka = ea.exifTime;     kb = eb.exifTime;     break;
+        case SortByName:         break;
+        }
+        result = (ka < kb) ? -1 : (ka > kb ? 1 : 0);
+    }
+
+    // 名称作为主键或相同时间/大小时的次键
+    if (result == 0) {
+        if (ea.nameKey && eb.nameKey) {
+            result = ea.nameKey->compare(*eb.nameKey);
+        } else {
+            result = naturalSortString(a).compare(naturalSortString(b), Qt::CaseInsensitive);
+        }
+        // 排序键相同（如 img7 与 img007）时按原始名称保证顺序稳定
+        if (result == 0) {
+            result = a.compare(b);
+        }
+    }
+
+    return m_descending ? -result : result;
+}
+
+bool ImageSorter::lessThan(const QString &a, const QString &b) const
+{
+    static const Entry emptyEntry;
+    auto ia = m_entries.constFind(a);
+    auto ib = m_entries.constFind(b);
+    const Entry &ea = (ia != m_entries.constEnd()) ? ia.value() : emptyEntry;
+    const Entry &eb = (ib != m_entries.constEnd()) ? ib.value() : emptyEntry;
+    return compareEntries(a, ea, b, eb) < 0;
+}
+
+void ImageSorter::sort(QStringList &names)
+{
+    PV_TRACE_SCOPE_CAT("sort", "scan");
+
+    // 先取出条目指针，比较时不再查哈希表
+    QList<QPair<QString, const Entry *>> items;
+    items.reserve(names.size());
+    static const Entry emptyEntry;
+    for (const QString &name : std::as_const(names)) {
+        auto it = m_entries.constFind(name);
+        items.append(qMakePair(name, it != m_entries.constEnd() ? &it.value() : &emptyEntry));
+    }
+
+    std::sort(items.begin(), items.end(), [this](const auto &x, const auto &y) {
+        return compareEntries(x.first, *x.second, y.first, *y.second) < 0;
+    });
+
+    for (int i = 0; i < items.size(); ++i) {
+        names[i] = items[i].first;
+    }
+}
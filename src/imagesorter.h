@@ -0,0 +1,77 @@
+// imagesorter.h
+#ifndef IMAGESORTER_H
+#define IMAGESORTER_H
+
+#include <QString>
+#include <QStringList>
+#include <QFileInfo>
+#include <QHash>
+#include <QCollatorSortKey>
+#include <optional>
+#include "cancellationtoken.h"
+
+// 图片列表排序：每次扫描时并行预先计算排序键（自然排序的 QCollatorSortKey、
+// 修改时间、大小），切换排序方式只比较缓存的键，不重新扫描目录。
+// EXIF 日期需要读文件头，由调用方在 I/O 池异步读取后用 setExifTimes 写回，
+// 读到之前按修改时间排序。
+class ImageSorter
+{
+public:
+    enum SortMode {
+        SortByName = 0,        // 自然排序（img2 在 img10 之前，按系统语言比较）
+        SortByModifiedTime,
+        SortBySize,
+        SortByExifDate         // 没有 EXIF 时用修改时间代替
+    };
+
+    ImageSorter();
+
+    void setMode(SortMode mode, bool descending);
+    SortMode mode() const { return m_mode; }
+    bool isDescending() const { return m_descending; }
+
+    // 目录扫描结果（使用 entryInfoList 已经 stat 过的信息，不再重复访问磁盘）
+    void setFiles(const QString &dirPath, const QFileInfoList &files);
+    // 压缩包内的条目只有名称可用，其他排序方式退回按名称排序
+    void setNames(const QStringList &names);
+    void clear();
+
+    // 增量更新（目录监视使用）
+    void addFile(const QFileInfo &fileInfo);
+    void removeFile(const QString &fileName);
+
+    // 按当前排序方式排序；名称必须已经通过 setFiles/setNames/addFile 登记
+    void sort(QStringList &names);
+    bool lessThan(const QString &a, const QString &b) const;
+
+    // 还没有读取 EXIF 日期的文件（名称，绝对路径）
+    QList<QPair<QString, QString>> pendingExifFiles() const;
+    // 在工作线程读取 EXIF 日期（毫秒，没有时为 0），不访问排序器本身
+    static QHash<QString, qint64> readExifTimes(const QList<QPair<QString, QString>> &files,
+                                                const CancellationToken &token);
+    // 写回读取结果；已经被移除或重新登记的文件不受影响
+    void setExifTimes(const QHash<QString, qint64> &times);
+
+    // 自然排序使用的名称形式：数字段补零到固定宽度
+    static QString naturalSortString(const QString &name);
+
+private:
+    struct Entry {
+        std::optional<QCollatorSortKey> nameKey;
+        qint64 modifiedTime = 0;
+        qint64 size = 0;
+        qint64 exifTime = 0;
+        bool exifLoaded = false;
+    };
+
+    void computeNameKeys(const QList<QPair<QString, Entry *>> &pending);
+    int compareEntries(const QString &a, const Entry &ea, const QString &b, const Entry &eb) const;
+
+    SortMode m_mode;
+    bool m_descending;
+    bool m_hasFileInfo;       // 压缩包模式下只有名称
+    QString m_dirPath;
+    QHash<QString, Entry> m_entries;
+};
+
+#endif // IMAGESORTER_H
@@ -9,15 +9,30 @@
 #include <QDir>
 #include <QTimer>
 #include <QMap>
+#include <QHash>
 #include <QtConcurrent>
 #include <QMutex>
+#include <QImageIOHandler>
+#include <QTransform>
+#include <functional>
 
 #include "configmanager.h"  // 添加配置管理器头文件
 #include "canvascontrolpanel.h"  // 添加控制面板头文件
 
 #include "archivehandler.h"
 #include "canvasoverlay.h"
-
+#include "folderwatcher.h"
+#include "imagesorter.h"
+#include "formatsniffer.h"
+#include "directoryscanner.h"
+#include "logging.h"
+#include "trace.h"
+#include "metrics.h"
+#include "perfhud.h"
+#include "alpharegion.h"
+#include "imagerendercache.h"
+
+class QMenu;
 
 class ImageWidget : public QWidget
 {
@@ -34,6 +49,21 @@ public:
 
     bool loadImage(const QString &filePath, bool fromCache = false);
     void loadImageList();
+    // 解码结果：decodeImageFile 可在任意线程调用（启动时与窗口构造并行），
+    // loadDecodedImage 在 GUI 线程上显示，效果与 loadImage 相同
+    struct DecodedImage {
+        QString path;
+        QImage image;   // 解码失败时为空
+        QImageIOHandler::Transformations transformation = QImageIOHandler::TransformationNone;
+    };
+    static DecodedImage decodeImageFile(const QString &filePath);
+    bool loadDecodedImage(DecodedImage decoded);
+    // 打开文件（单图视图）或目录（缩略图视图）
+    void openPath(const QString &path);
+    // 在本进程内新建一个顶层窗口（关闭时自动释放），与其他窗口共用缓存和线程池
+    static ImageWidget *openWindow(const QString &path);
+    // 第一帧绘制之后再执行（已绘制过则在下一轮事件循环执行），用于推迟不影响首屏的工作
+    void runAfterFirstPaint(std::function<void()> work);
     bool loadImageByIndex(int index, bool fromCache = true);
     void loadNextImage();
     void loadPreviousImage();
@@ -45,9 +75,9 @@ public:
     void setSlideshowInterval(int interval); // 添加这行声明
     void slideshowNext();
     void updateWindowTitle();
-    QString getShortPathName(const QString &longPath);
+    static QString getShortPathName(const QString &longPath);
     void logMessage(const QString &message);
-    void registerFileAssociation(const QString &fileExtension,
+    static void registerFileAssociation(const QString &fileExtension,
                                  const QString &fileTypeName,
                                  const QString &openCommand);
     void switchToSingleView(int index = -1);
@@ -72,6 +102,8 @@ protected:
     void resizeEvent(QResizeEvent *event) override;
 
     void closeEvent(QCloseEvent *event) override;  // 添加关闭事件处理
+    void changeEvent(QEvent *event) override;
+    bool eventFilter(QObject *watched, QEvent *event) override;
 
 private slots:
     void onThumbnailClicked(int index);
@@ -104,7 +136,14 @@ private:
     int slideshowInterval;
     QTimer *slideshowTimer;
 
-    QMap<QString, QPixmap> imageCache;
+    // 原图缓存：进程内所有窗口共用一份（键为绝对路径），由 cacheMutex 保护
+    struct SharedImageCache {
+        QMap<QString, QPixmap> images;
+        QMutex mutex;
+        int windowCount = 0;   // 存活的窗口数（仅 GUI 线程访问），最后一个窗口析构时清空
+    };
+    static SharedImageCache &sharedImageCache();
+    QMap<QString, QPixmap> &imageCache;
 
     ViewMode currentViewMode;
     QSize thumbnailSize;
@@ -126,7 +165,7 @@ public:
     int getLastImageIndex() const { return currentConfig.lastImageIndex; }
     //多线程互斥体
 private:
-    QMutex cacheMutex; // 用于保护 imageCache 的访问
+    QMutex &cacheMutex; // 用于保护 imageCache 的访问（与其他窗口共用）
 
     //
 public:
@@ -201,6 +240,24 @@ private:
     void enableCanvasMode();
     void disableCanvasMode();
     bool isCanvasModeEnabled();
+    void syncCanvasOverlay();   // 画布模式下把当前图片和视图参数增量同步到覆盖层
+
+    // 参考图板：画布模式下与主图同时显示的参考图，退出画布模式后保留，再次进入时恢复。
+    // 从文件添加时先查原图缓存，未命中才解码并放入缓存，同一文件只解码一次
+    QVector<CanvasOverlay::Reference> canvasReferences;
+    QVector<int> canvasReferenceIds;   // 画布模式下每张参考图在覆盖层里的编号，与 canvasReferences 一一对应
+    void pinCurrentImageAsReference();
+    void addReferenceImages();
+    void loadReferenceImage(const QString &filePath);
+    void addCanvasReference(const QPixmap &referencePixmap, const QTransform &orientation);
+    // 画布模式下覆盖层鼠标穿透，单张参考图的调整通过菜单进行：
+    // 普通模式在右键菜单里，画布模式从控制面板的"参考图"按钮打开同一个菜单
+    void populateReferenceMenu(QMenu *referenceMenu);
+    void showReferenceMenu(const QPoint &globalPos);
+    void setCanvasReferenceView(int index, const QPointF &position, double scale);
+    void setCanvasReferenceOpacity(int index, double opacity);
+    void removeCanvasReference(int index);
+    void clearCanvasReferences();
 
     // 鼠标穿透控制
     void enableMousePassthrough();
@@ -227,6 +284,7 @@ private slots:
 
 private:
     void createShortcutActions(); // 创建快捷键动作
+    void claimApplicationShortcuts();  // 多窗口时由当前激活的窗口持有应用级快捷键
 
     // 快捷键动作
     QAction *openFolderAction;
@@ -247,17 +305,33 @@ private:
     void rotate180();           // 旋转180度
     void resetTransform();      // 重置变换
 
-    void applyTransformations();  // 应用所有变换的核心函数
+    void applyTransformations();  // 变换状态改变后刷新视图（不重新生成像素）
 
     // 变换状态
     bool isTransformed() const; // 检查是否有变换
 
 private:
-    // 变换相关变量
+    // 变换相关变量：pixmap 始终是解码出的原图，EXIF 方向和用户旋转/镜像
+    // 都在绘制时作为坐标变换施加，旋转大图不产生整图副本
     int rotationAngle;           // 旋转角度 (0, 90, 180, 270)
     bool isHorizontallyFlipped;  // 水平镜像
     bool isVerticallyFlipped;    // 垂直镜像
-    QPixmap originalPixmap;      // 存储原始图片，用于重置变换
+    QImageIOHandler::Transformations exifTransformation;  // 文件自带的方向
+
+    QSize displaySize() const;                 // 方向变换后的图片尺寸
+    QTransform orientationTransform() const;   // 原图像素 → 方向变换后的图片坐标（左上角为原点）
+    static QTransform orientationFor(const QSize &imageSize, QImageIOHandler::Transformations exif,
+                                     int userRotation = 0, bool horizontalFlip = false, bool verticalFlip = false);
+    QTransform imageToWidgetTransform() const; // 原图像素 → 窗口坐标（含缩放和平移）
+    QPixmap orientedPixmap() const;            // 按当前方向生成整图，只用于保存/复制等显式操作
+
+    // 可见块缩放缓存，与画布覆盖层共用
+    ImageRenderCache renderCache;
+
+public:
+    ImageRenderCache *sharedRenderCache() { return &renderCache; }
+
+private:
 
     // 压缩包处理
     // 压缩包处理
@@ -270,7 +344,7 @@ private:
     bool openArchive(const QString &filePath);
     void closeArchive();
     void loadArchiveImageList();
-    bool loadImageFromArchive(const QString &filePath);
+    bool loadImageFromArchive(const QString &filePath, bool fromCache = false);
 
 public:
     QPixmap getArchiveThumbnail(const QString &archivePath);
@@ -329,6 +403,9 @@ private:
 private:
     void updateMask();                       // 更新窗口掩码
     bool m_maskDirty = false;                // 标记是否需要更新掩码
+    // 平移等高频操作只标记掩码需要更新，每帧（约 16ms）最多向 X 服务器提交一次
+    void scheduleMaskUpdate();
+    QTimer maskUpdateTimer;
 
     void setMask(const QRegion &region) ;
     void clearMask() ;
@@ -337,6 +414,21 @@ private:
     void clearX11Shape();            // 清除输入形状（全窗口可点）
     void setX11ShapeRect(const QRect &rect); // 设置单一矩形形状
     void setX11Shape(const QRegion &region); // 设置复杂形状（多个矩形）
+    void setX11ShapeRects(const QVector<QRect> &rects, bool banded = true); // 直接提交矩形列表
+    // 最近一次提交的输入形状；与新形状相同时跳过，窗口重建（winId 变化）后重新提交
+    WId m_inputShapeWindow = 0;
+    bool m_inputShapeCleared = false;
+    QVector<QRect> m_appliedInputShape;
+
+    // 带透明通道图片的输入形状：在原图坐标系下按缩放级别（2 的幂）缓存，
+    // 平移、旋转和同一级别内的缩放只需映射并裁剪到窗口，不再重新扫描像素。
+    // 级别变化时在 CPU 池重新提取，结果到达前继续使用旧级别的形状
+    qint64 m_shapeImageKey = 0;
+    AlphaRegion::LevelRegion m_shapeRegion;
+    int m_pendingShapeLevel = -1;
+    GenerationCounter shapeGeneration;
+    int shapeLevelFor(const QTransform &view) const;
+    void requestShapeRegion(int level);
 
 private:
     void forceX11ShapeRefresh();  // 强制 X11 刷新窗口形状
@@ -372,6 +464,56 @@ private:
 private slots:
     void openImageInNewWindow();
 
+private:
+    // 目录实时监视：增量更新 imageList 和缩略图
+    FolderWatcher *folderWatcher;
+    bool isListableFile(const QString &fileName) const;
+    int sortedInsertPosition(const QString &fileName) const;
+private slots:
+    void onWatchedFilesWritten(const QStringList &fileNames);
+    void onWatchedFilesRemoved(const QStringList &fileNames);
+    void onWatchedFileRenamed(const QString &oldName, const QString &newName);
+    void onWatchedFolderRescan();
+
+private:
+    // 排序：键在扫描时预先计算，切换排序方式不重新扫描
+    ImageSorter imageSorter;
+    void setSortMode(ImageSorter::SortMode mode, bool descending);
+    void moveToSortedPosition(int index);
+    // 按当前排序方式重排 imageList 和缩略图，保持当前图片不变
+    void applySortOrder();
+    // 按拍摄日期排序时在 I/O 池读取缺少的 EXIF 日期，读完后重排；切换目录时作废
+    GenerationCounter exifGeneration;
+    void requestExifSortKeys();
+
+private:
+    // 幻灯片预加载（后台解码，可取消）
+    GenerationCounter prefetchGeneration;
+    void prefetchImage(int index);
+    // 预加载时顺带解析的 EXIF 方向（缓存里是未旋转的原图），随缓存条目一起增删
+    QHash<QString, QImageIOHandler::Transformations> prefetchedTransformations;
+    // 查原图缓存：命中时返回缓存的 pixmap 和绘制时要施加的 EXIF 方向
+    bool findCachedImage(const QString &cacheKey, bool fromArchive,
+                         QPixmap &cachedPixmap, QImageIOHandler::Transformations &transformation);
+    // 显示已经解码好的图片（解码结果或缓存命中）
+    bool showLoadedPixmap(const QPixmap &loadedPixmap, QImageIOHandler::Transformations transformation,
+                          const QString &filePath);
+
+    // 原图缓存（imageCache / archiveImageCache）的增删都经过这里，顺带更新性能计数器的占用字节数
+    void insertCachedImage(QMap<QString, QPixmap> &cache, const QString &key, const QPixmap &pixmap);
+    void removeCachedImage(QMap<QString, QPixmap> &cache, const QString &key);
+    void clearCachedImages(QMap<QString, QPixmap> &cache);
+
+private:
+    // 性能浮层（F12）
+    PerfHud *perfHud;
+
+    // 启动：第一帧之前推迟的工作
+    bool m_firstPaintDone = false;
+    QVector<std::function<void()>> m_afterFirstPaint;
+    void notifyFirstPaint();
+public slots:
+    void togglePerfHud();
 
 };
 
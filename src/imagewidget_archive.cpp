@@ -12,7 +12,7 @@
 bool ImageWidget::openArchive(const QString &filePath)
 {
     if (!archiveHandler.openArchive(filePath)) {
-        qDebug() << "无法打开压缩包:" << filePath;
+        qCDebug(lcArchive) << "无法打开压缩包:" << filePath;
         return false;
     }
 
@@ -22,9 +22,17 @@ bool ImageWidget::openArchive(const QString &filePath)
     previousImageIndex = currentImageIndex;
     previousViewMode = currentViewMode;
 
+    // 压缩包模式下 imageList 是压缩包内条目，暂停目录监视
+    folderWatcher->stop();
+
     isArchiveMode = true;
     currentArchivePath = filePath;
-    archiveImageCache.clear(); // 清空缓存
+    prefetchGeneration.advance();  // 目录中的预加载任务作废
+    exifGeneration.advance();
+    {
+        QMutexLocker locker(&cacheMutex);
+        clearCachedImages(archiveImageCache); // 清空缓存
+    }
 
     // 加载压缩包中的图片列表
     loadArchiveImageList();
@@ -33,7 +41,7 @@ bool ImageWidget::openArchive(const QString &filePath)
     switchToThumbnailView();
 
     updateWindowTitle();
-    qDebug() << "成功打开压缩包，包含" << imageList.size() << "个文件";
+    qCDebug(lcArchive) << "成功打开压缩包，包含" << imageList.size() << "个文件";
     return true;
 }
 
@@ -41,18 +49,23 @@ void ImageWidget::exitArchiveMode()
 {
     if (!isArchiveMode) return;
 
-    qDebug() << "退出压缩包模式";
+    qCDebug(lcArchive) << "退出压缩包模式";
 
     // 关闭压缩包
     closeArchive();
 
     // 恢复之前的状态
     currentDir = previousDir;
-    imageList = previousImageList;
-    currentImageIndex = previousImageIndex;
-
-    // 重新加载图片列表
-    thumbnailWidget->setImageList(imageList, currentDir);
+    QString previousFileName = previousImageList.value(previousImageIndex);
+
+    // 浏览压缩包期间目录未被监视，重新扫描（同时恢复目录监视）
+    imageList.clear();
+    loadImageList();
+    if (imageList.isEmpty()) {
+        // loadImageList 只在列表变化时刷新缩略图，空目录需要手动清掉压缩包条目
+        thumbnailWidget->setImageList(imageList, currentDir);
+    }
+    currentImageIndex = previousFileName.isEmpty() ? -1 : imageList.indexOf(previousFileName);
 
     // 恢复之前的视图模式
     if (previousViewMode == ThumbnailView) {
@@ -66,7 +79,7 @@ void ImageWidget::exitArchiveMode()
     }
 
     updateWindowTitle();
-    qDebug() << "已返回到目录:" << currentDir.absolutePath();
+    qCDebug(lcArchive) << "已返回到目录:" << currentDir.absolutePath();
 }
 
 void ImageWidget::closeArchive()
@@ -83,14 +96,15 @@ void ImageWidget::loadArchiveImageList()
 {
     if (!isArchiveMode) return;
 
-    qDebug() << "=== 加载压缩包图片列表 ===";
+    qCDebug(lcArchive) << "=== 加载压缩包图片列表 ===";
 
     QStringList archiveImageList = archiveHandler.getImageFiles();
-    archiveImageList.sort();
+    imageSorter.setNames(archiveImageList);
+    imageSorter.sort(archiveImageList);
 
-    qDebug() << "排序后的图片列表:";
+    qCDebug(lcArchive) << "排序后的图片列表:";
     for (int i = 0; i < archiveImageList.size(); ++i) {
-        qDebug() << "  " << i << ":" << archiveImageList[i];
+        qCDebug(lcArchive) << "  " << i << ":" << archiveImageList[i];
     }
 
     // 保存原始文件名列表
@@ -101,33 +115,46 @@ void ImageWidget::loadArchiveImageList()
     for (const QString &fileName : std::as_const(archiveImageList)) {
         QString fullPath = currentArchivePath + "|" + fileName;
         thumbnailPaths.append(fullPath);
-        qDebug() << "构建缩略图路径:" << fullPath;
+        qCDebug(lcArchive) << "构建缩略图路径:" << fullPath;
     }
 
     // 传递给缩略图部件
     thumbnailWidget->setImageList(thumbnailPaths, QDir());
 
-    qDebug() << "从压缩包中找到图片文件:" << imageList.size() << "个";
-    qDebug() << "传递给缩略图部件的路径数量:" << thumbnailPaths.size();
+    qCDebug(lcArchive) << "从压缩包中找到图片文件:" << imageList.size() << "个";
+    qCDebug(lcArchive) << "传递给缩略图部件的路径数量:" << thumbnailPaths.size();
 }
 
-bool ImageWidget::loadImageFromArchive(const QString &filePath)
+bool ImageWidget::loadImageFromArchive(const QString &filePath, bool fromCache)
 {
+    PV_TRACE_SCOPE_CAT("loadImageFromArchive", "decode");
     if (!isArchiveMode) return false;
 
-    QByteArray imageData = archiveHandler.extractFile(filePath);
-    if (imageData.isEmpty()) {
-        return false;
-    }
+    // 预加载过的条目直接用缓存，不再解压解码
+    QPixmap cachedPixmap;
+    QImageIOHandler::Transformations transformation;
+    if (fromCache && findCachedImage(filePath, true, cachedPixmap, transformation)) {
+        pixmap = cachedPixmap;
+        exifTransformation = transformation;
+    } else {
+        QByteArray imageData = archiveHandler.extractFile(filePath);
+        if (imageData.isEmpty()) {
+            return false;
+        }
 
-    QPixmap loadedPixmap;
-    if (!loadedPixmap.loadFromData(imageData)) {
-        return false;
-    }
+        // 按数据头直接选择解码器；EXIF 方向在绘制时施加
+        FormatSniffer::Format format = FormatSniffer::fromHeader(imageData.left(FormatSniffer::kHeaderSize));
+        QBuffer buffer(&imageData);
+        QImageReader reader(&buffer, FormatSniffer::decoderFormat(format));
+        reader.setAutoTransform(false);
+        QImage image;
+        if (!reader.read(&image)) {
+            return false;
+        }
 
-    // 保存原始图片并重置变换状态
-    originalPixmap = loadedPixmap;
-    pixmap = loadedPixmap;
+        pixmap = QPixmap::fromImage(std::move(image));
+        exifTransformation = reader.transformation();
+    }
 
     // 重置变换状态
     rotationAngle = 0;
@@ -160,9 +187,6 @@ bool ImageWidget::loadImageFromArchive(const QString &filePath)
 
 QPixmap ImageWidget::getArchiveThumbnail(const QString &archivePath)
 {
-    qDebug() << "=== getArchiveThumbnail 详细调试 ===";
-    qDebug() << "输入路径:" << archivePath;
-
     // 顶层压缩包文件（不包含 '|'） → 直接返回默认图标，绝不读取压缩包内容
     if (!archivePath.contains('|')) {
         static QPixmap defaultArchiveIcon;
@@ -175,8 +199,10 @@ QPixmap ImageWidget::getArchiveThumbnail(const QString &archivePath)
     // 以下是压缩包内部图片的提取逻辑（保持不变）
     // 使用完整路径作为缓存键
     if (archiveImageCache.contains(archivePath)) {
+        Metrics::cacheHit(Metrics::ImageTier);
         return archiveImageCache.value(archivePath);
     }
+    Metrics::cacheMiss(Metrics::ImageTier);
 
     QStringList parts = archivePath.split("|");
     if (parts.size() != 2) {
@@ -186,26 +212,17 @@ QPixmap ImageWidget::getArchiveThumbnail(const QString &archivePath)
     QString archiveFile = parts[0];
     QString internalFile = parts[1];
 
-    qDebug() << "解析结果:";
-    qDebug() << "  - 压缩包:" << archiveFile;
-    qDebug() << "  - 内部文件:" << internalFile;
-
     // 检查文件是否存在
     if (!QFile::exists(archiveFile)) {
-        qDebug() << "压缩包文件不存在:" << archiveFile;
+        qCDebug(lcArchive) << "压缩包文件不存在:" << archiveFile;
         return createDefaultArchiveThumbnail();
     }
 
-    qDebug() << "从压缩包提取文件:" << internalFile;
-
     // 使用 ArchiveHandler 提取文件
     QByteArray imageData = archiveHandler.extractFile(internalFile);
 
-    qDebug() << "提取结果:";
-    qDebug() << "  - 数据大小:" << imageData.size();
-
     if (imageData.isEmpty()) {
-        qDebug() << "!!! 提取的数据为空 !!!";
+        qCWarning(lcArchive) << "压缩包条目提取为空:" << archivePath;
 
         // 创建错误提示图片
         QImage errorImage(thumbnailSize, QImage::Format_RGB32);
@@ -220,54 +237,26 @@ QPixmap ImageWidget::getArchiveThumbnail(const QString &archivePath)
         QPixmap errorThumb = QPixmap::fromImage(errorImage);
 
         QMutexLocker locker(&cacheMutex);
-        archiveImageCache.insert(archivePath, errorThumb);
+        insertCachedImage(archiveImageCache, archivePath, errorThumb);
         return errorThumb;
     }
 
-    // 检查数据前几个字节（图片文件签名）
-    QByteArray header = imageData.left(8);
-    qDebug() << "  - 数据前8字节(HEX):" << header.toHex();
-
-    // 方法1: 使用 QImage 加载
+    // 按数据头选择解码器，只解码一次
+    FormatSniffer::Format format = FormatSniffer::fromHeader(imageData.left(FormatSniffer::kHeaderSize));
     QImage image;
-    if (image.loadFromData(imageData)) {
-        qDebug() << "✅ QImage加载成功:";
-        qDebug() << "  - 原始尺寸:" << image.size();
-        qDebug() << "  - 格式:" << image.format();
-        qDebug() << "  - 深度:" << image.depth();
-
+    if (image.loadFromData(imageData, FormatSniffer::decoderFormat(format).constData())) {
         // 缩放到缩略图大小
         QImage scaledImage = image.scaled(thumbnailSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
         QPixmap thumbnail = QPixmap::fromImage(scaledImage);
 
-        qDebug() << "  - 缩略图尺寸:" << thumbnail.size();
-
         // 缓存并返回
         QMutexLocker locker(&cacheMutex);
-        archiveImageCache.insert(archivePath, thumbnail);
-        return thumbnail;
-    } else {
-        qDebug() << "❌ QImage加载失败";
-    }
-
-    // 方法2: 使用 QPixmap 作为备选
-    QPixmap pixmap;
-    if (pixmap.loadFromData(imageData)) {
-        qDebug() << "✅ QPixmap加载成功:";
-        qDebug() << "  - 原始尺寸:" << pixmap.size();
-
-        QPixmap thumbnail = pixmap.scaled(thumbnailSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-        qDebug() << "  - 缩略图尺寸:" << thumbnail.size();
-
-        QMutexLocker locker(&cacheMutex);
-        archiveImageCache.insert(archivePath, thumbnail);
+        insertCachedImage(archiveImageCache, archivePath, thumbnail);
         return thumbnail;
     } else {
-        qDebug() << "❌ QPixmap加载也失败";
+        qCDebug(lcArchive) << "❌ 图片解码失败，格式:" << FormatSniffer::decoderFormat(format);
     }
 
-    qDebug() << "❌ 所有图片加载方法都失败";
-
     // 创建加载失败提示图片（不是压缩包图标）
     QImage failedImage(thumbnailSize, QImage::Format_RGB32);
     failedImage.fill(QColor(255, 100, 100));
@@ -284,7 +273,7 @@ QPixmap ImageWidget::getArchiveThumbnail(const QString &archivePath)
     QPixmap failedThumb = QPixmap::fromImage(failedImage);
 
     QMutexLocker locker(&cacheMutex);
-    archiveImageCache.insert(archivePath, failedThumb);
+    insertCachedImage(archiveImageCache, archivePath, failedThumb);
     return failedThumb;
 }
 
@@ -324,8 +313,5 @@ QPixmap ImageWidget::createDefaultArchiveThumbnail()
 
 bool ImageWidget::isArchiveFile(const QString &fileName) const
 {
-    QString lowerName = fileName.toLower();
-    return (lowerName.endsWith(".zip") || lowerName.endsWith(".rar") ||
-            lowerName.endsWith(".7z") || lowerName.endsWith(".tar") ||
-            lowerName.endsWith(".gz") || lowerName.endsWith(".bz2"));
+    return FormatSniffer::isArchiveFile(currentDir.absoluteFilePath(fileName));
 }
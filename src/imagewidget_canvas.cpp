@@ -4,6 +4,11 @@
 #include "qpainter.h"
 #include <QScreen>
 #include <QGuiApplication>
+#include <QFileDialog>
+#include <QFutureWatcher>
+#include "exifreader.h"
+#include "thumbnailloader.h"
+#include "threadpools.h"
 
 #ifdef _WIN32
 
@@ -22,6 +27,7 @@ extern "C" {
 #include <X11/Xlib.h>
 #include <X11/extensions/shape.h>
 }
+#include "x11display.h"
 
 #endif
 
@@ -36,6 +42,8 @@ void ImageWidget::createControlPanel()
         controlPanel = new CanvasControlPanel(parentForPanel);
         connect(controlPanel, &CanvasControlPanel::exitCanvasMode, this,
                 &ImageWidget::onExitCanvasMode);
+        connect(controlPanel, &CanvasControlPanel::referenceMenuRequested, this,
+                &ImageWidget::showReferenceMenu);
         positionControlPanel();
         controlPanel->show();
 
@@ -96,12 +104,14 @@ void ImageWidget::enableCanvasMode()
     // 1. 创建 CanvasOverlay 的 DisplayState
     CanvasOverlay::DisplayState displayState;
 
-    // 优先使用 pixmap，如果 pixmap 为空，尝试使用 currentImage
+    // 优先使用 pixmap，如果 pixmap 为空，尝试使用 currentImage。
+    // 覆盖层与主窗口共享同一份像素（隐式共享），方向在绘制时变换，不生成整图副本
     if (!pixmap.isNull()) {
-        displayState.image = pixmap.toImage();  // 将 QPixmap 转换为 QImage
+        displayState.pixmap = pixmap;
+        displayState.orientation = orientationTransform();
         qDebug() << "使用 pixmap 创建 DisplayState，尺寸:" << pixmap.size();
     } else if (!currentImage.isNull()) {
-        displayState.image = currentImage;
+        displayState.pixmap = QPixmap::fromImage(currentImage);
         qDebug() << "使用 currentImage 创建 DisplayState，尺寸:" << currentImage.size();
     } else {
         qWarning() << "pixmap 和 currentImage 都为空，无法显示图片";
@@ -110,19 +120,20 @@ void ImageWidget::enableCanvasMode()
     displayState.scaleFactor = scaleFactor;
     displayState.panOffset = panOffset;
 
-    // 计算图片显示区域
-    if (!displayState.image.isNull()) {
-        QSize scaledSize = displayState.image.size() * scaleFactor;
-        QRect imageRect = QRect(QPoint(0, 0), scaledSize);
-        imageRect.moveCenter(rect().center() + panOffset.toPoint());
-        displayState.imageRect = imageRect;
-        qDebug() << "计算出的图片显示区域:" << imageRect;
+    // 计算图片显示区域（与 paintEvent 使用同一个变换，覆盖层可直接复用主窗口的缩放缓存）
+    if (!pixmap.isNull()) {
+        displayState.imageRect = imageToWidgetTransform().mapRect(QRectF(pixmap.rect())).toRect();
+        qDebug() << "计算出的图片显示区域:" << displayState.imageRect;
     }
 
     // 2. 创建并配置覆盖层窗口
     canvasOverlay = new CanvasOverlay(this);
     canvasOverlay->setGeometry(geometry());
     canvasOverlay->setDisplayState(displayState);
+    canvasReferenceIds.clear();
+    for (const CanvasOverlay::Reference &reference : std::as_const(canvasReferences)) {
+        canvasReferenceIds.append(canvasOverlay->addReference(reference));
+    }
 
 
     // 新增：根据主窗口当前透明度调整覆盖层透明度
@@ -151,18 +162,14 @@ void ImageWidget::enableCanvasMode()
         if (canvasOverlay) {
             canvasOverlay->setAttribute(Qt::WA_TransparentForMouseEvents, true);
 #ifdef Q_OS_LINUX
-            if (QGuiApplication::platformName().contains("xcb")) {
-                Display *display = XOpenDisplay(nullptr);
-                if (display) {
-                    Window windowId = (Window)canvasOverlay->winId();
-                    if (windowId) {
-                        // 完全穿透：清除所有输入区域
-                        XShapeCombineRectangles(display, windowId, ShapeInput,
-                                                0, 0, nullptr, 0, ShapeSet, YXBanded);
-                        XFlush(display);
-                        qDebug() << "CanvasOverlay 完全鼠标穿透已设置";
-                    }
-                    XCloseDisplay(display);
+            if (Display *display = X11Display::get()) {
+                Window windowId = (Window)canvasOverlay->winId();
+                if (windowId) {
+                    // 完全穿透：清除所有输入区域
+                    XShapeCombineRectangles(display, windowId, ShapeInput,
+                                            0, 0, nullptr, 0, ShapeSet, YXBanded);
+                    XFlush(display);
+                    qDebug() << "CanvasOverlay 完全鼠标穿透已设置";
                 }
             }
 #endif
@@ -181,6 +188,155 @@ void ImageWidget::enableCanvasMode()
     qDebug() << "画布模式已启用（覆盖层方案）";
 }
 
+void ImageWidget::syncCanvasOverlay()
+{
+    if (!canvasOverlay || pixmap.isNull()) return;
+
+    // 内容未变时 setContent 不重绘；视图参数只重绘旧/新显示区域
+    canvasOverlay->setContent(pixmap, orientationTransform());
+    canvasOverlay->setView(scaleFactor, panOffset,
+                           imageToWidgetTransform().mapRect(QRectF(pixmap.rect())).toRect());
+}
+
+void ImageWidget::pinCurrentImageAsReference()
+{
+    if (pixmap.isNull()) return;
+    // 与主窗口共享像素，方向按当前显示固定下来
+    addCanvasReference(pixmap, orientationTransform());
+}
+
+void ImageWidget::addReferenceImages()
+{
+    const QStringList files = QFileDialog::getOpenFileNames(
+        this, tr("添加参考图"), currentDir.absolutePath(),
+        tr("图片文件 (*.png *.jpg *.jpeg *.bmp *.webp *.gif *.tiff *.tif)"));
+    for (const QString &filePath : files) {
+        loadReferenceImage(QFileInfo(filePath).absoluteFilePath());
+    }
+}
+
+void ImageWidget::loadReferenceImage(const QString &filePath)
+{
+    QPixmap cached;
+    {
+        QMutexLocker locker(&cacheMutex);
+        cached = imageCache.value(filePath);
+    }
+    if (!cached.isNull()) {
+        Metrics::cacheHit(Metrics::ImageTier);
+    } else {
+        Metrics::cacheMiss(Metrics::ImageTier);
+    }
+
+    // 读取在 I/O 池、解码在 CPU 池；命中缓存时只读 EXIF 方向（文件头 64KB）
+    struct Loaded {
+        QByteArray data;
+        QImage image;
+        int exifOrientation = 1;
+    };
+    const bool decode = cached.isNull();
+    QFuture<Loaded> future = QtConcurrent::task([filePath, decode]() {
+                                 Loaded loaded;
+                                 if (!decode) {
+                                     loaded.exifOrientation = ExifReader::read(filePath).orientation;
+                                     return loaded;
+                                 }
+                                 loaded.data = ThumbnailLoader::readSource(filePath);
+                                 loaded.exifOrientation = ExifReader::readFromData(loaded.data).orientation;
+                                 return loaded;
+                             })
+                                 .onThreadPool(*ThreadPools::io())
+                                 .withPriority(ThreadPools::PriorityNextImage)
+                                 .spawn()
+                                 .then(ThreadPools::cpu(), [filePath](Loaded loaded) {
+                                     if (!loaded.data.isEmpty()) {
+                                         loaded.image = ThumbnailLoader::decodeData(loaded.data, filePath);
+                                         loaded.data.clear();
+                                     }
+                                     return loaded;
+                                 });
+
+    auto *watcher = new QFutureWatcher<Loaded>(this);
+    connect(watcher, &QFutureWatcher<Loaded>::finished, this, [this, watcher, filePath, cached]() {
+        Loaded loaded = watcher->result();
+        watcher->deleteLater();
+
+        QPixmap referencePixmap = cached;
+        if (referencePixmap.isNull()) {
+            if (loaded.image.isNull()) {
+                qWarning() << "参考图加载失败:" << filePath;
+                return;
+            }
+            referencePixmap = QPixmap::fromImage(std::move(loaded.image));
+            QMutexLocker locker(&cacheMutex);
+            insertCachedImage(imageCache, filePath, referencePixmap);
+        }
+
+        addCanvasReference(referencePixmap,
+                           orientationFor(referencePixmap.size(),
+                                          ExifReader::transformation(loaded.exifOrientation)));
+    });
+    watcher->setFuture(future);
+}
+
+void ImageWidget::addCanvasReference(const QPixmap &referencePixmap, const QTransform &orientation)
+{
+    CanvasOverlay::Reference reference;
+    reference.pixmap = referencePixmap;
+    reference.orientation = orientation;
+
+    // 默认缩到窗口短边的三分之一以内，从左上角依次错开摆放
+    const QSize size = reference.displaySize();
+    const double side = qMin(width(), height()) / 3.0;
+    reference.scale = qMin(1.0, side / qMax(1, qMax(size.width(), size.height())));
+    const int slot = canvasReferences.size() % 8;
+    reference.position = QPointF(20 + 40 * slot, 20 + 40 * slot);
+
+    canvasReferences.append(reference);
+    if (canvasOverlay) {
+        canvasReferenceIds.append(canvasOverlay->addReference(reference));
+    }
+    qDebug() << "参考图已添加，共" << canvasReferences.size() << "张";
+}
+
+void ImageWidget::setCanvasReferenceView(int index, const QPointF &position, double scale)
+{
+    if (index < 0 || index >= canvasReferences.size()) return;
+    scale = qBound(0.05, scale, 8.0);
+    canvasReferences[index].position = position;
+    canvasReferences[index].scale = scale;
+    if (canvasOverlay) {
+        canvasOverlay->setReferenceView(canvasReferenceIds.value(index), position, scale);
+    }
+}
+
+void ImageWidget::setCanvasReferenceOpacity(int index, double opacity)
+{
+    if (index < 0 || index >= canvasReferences.size()) return;
+    canvasReferences[index].opacity = qBound(0.0, opacity, 1.0);
+    if (canvasOverlay) {
+        canvasOverlay->setReferenceOpacity(canvasReferenceIds.value(index), opacity);
+    }
+}
+
+void ImageWidget::removeCanvasReference(int index)
+{
+    if (index < 0 || index >= canvasReferences.size()) return;
+    canvasReferences.removeAt(index);
+    if (canvasOverlay && index < canvasReferenceIds.size()) {
+        canvasOverlay->removeReference(canvasReferenceIds.takeAt(index));
+    }
+}
+
+void ImageWidget::clearCanvasReferences()
+{
+    canvasReferences.clear();
+    canvasReferenceIds.clear();
+    if (canvasOverlay) {
+        canvasOverlay->clearReferences();
+    }
+}
+
 void ImageWidget::disableCanvasMode()
 {
     qDebug() << "禁用画布模式（覆盖层方案）";
@@ -195,6 +351,7 @@ void ImageWidget::disableCanvasMode()
         canvasOverlay->hide();
         canvasOverlay->deleteLater();
         canvasOverlay = nullptr;
+        canvasReferenceIds.clear();
     }
 
     // 3. 恢复原窗口显示
@@ -224,12 +381,10 @@ void ImageWidget::enableMousePassthrough()
     if (QGuiApplication::platformName().contains("xcb")) {
         qDebug() << "✓ 确认为X11环境";
 
-        // **尝试使用XOpenDisplay（传统方式）**
-        qDebug() << "尝试使用XOpenDisplay打开显示连接...";
-        Display *display = XOpenDisplay(nullptr);
+        // 使用与 Qt 共用的长连接
+        Display *display = X11Display::get();
 
         if (display) {
-            qDebug() << "✓ XOpenDisplay成功";
 
             // **检查XShape扩展是否可用**
             int event_base, error_base;
@@ -252,22 +407,17 @@ void ImageWidget::enableMousePassthrough()
                 XShapeCombineRectangles(display, windowId, ShapeInput,
                                         0, 0, nullptr, 0, ShapeSet, YXBanded);
                 XFlush(display);
+                // 记录为"空形状"，之后 clearX11Shape 才不会被当作重复请求跳过
+                m_inputShapeWindow = windowId;
+                m_inputShapeCleared = false;
+                m_appliedInputShape.clear();
                 qDebug() << "✓ X11鼠标穿透设置完成";
-
-                // **注意：这里不能关闭display，需要在disableMousePassthrough中处理**
             } else {
                 qWarning() << "✗ X服务器不支持XShape扩展，无法实现高级鼠标穿透";
             }
 
-            // **同时也尝试Qt原生接口（作为备选）**
-            qDebug() << "尝试Qt原生接口...";
-            if (auto *x11App = qApp->nativeInterface<QNativeInterface::QX11Application>()) {
-                Display *qtDisplay = x11App->display();
-                qDebug() << "Qt原生接口获取的Display:" << (qtDisplay ? "有效" : "无效");
-            }
-
         } else {
-            qCritical() << "✗ XOpenDisplay失败!";
+            qCritical() << "✗ 无法获取X11显示连接!";
             qDebug() << "可能原因:";
             qDebug() << "  1. 不在图形环境中运行";
             qDebug() << "  2. 没有正确的DISPLAY设置";
@@ -309,14 +459,10 @@ bool ImageWidget::isCanvasModeEnabled()
 void ImageWidget::forceX11ShapeRefresh()
 {
 #ifdef Q_OS_LINUX
-    if (!QGuiApplication::platformName().contains("xcb")) return;
-    Display *display = XOpenDisplay(nullptr);
+    Display *display = X11Display::get();
     if (!display) return;
     Window windowId = (Window)winId();
-    if (!windowId) {
-        XCloseDisplay(display);
-        return;
-    }
+    if (!windowId) return;
 
     // 发送一个 ConfigureNotify 事件，模拟窗口配置变化（但大小不变）
     XEvent event;
@@ -330,7 +476,6 @@ void ImageWidget::forceX11ShapeRefresh()
     event.xconfigure.override_redirect = False;
     XSendEvent(display, windowId, False, StructureNotifyMask, &event);
     XFlush(display);
-    XCloseDisplay(display);
 
     qDebug() << "X11 刷新事件已发送";
 #endif
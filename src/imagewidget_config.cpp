@@ -1,10 +1,12 @@
 // imagewidget_config.cpp
 #include "imagewidget.h"
+#include "thumbnaildiskcache.h"
 #include <QCloseEvent>
 #include <QGuiApplication>
 #ifdef Q_OS_LINUX
 #include <X11/Xlib.h>
 #include <X11/extensions/shape.h>
+#include "x11display.h"
 #endif
 
 #include <QProcess>
@@ -16,6 +18,8 @@ void ImageWidget::closeEvent(QCloseEvent *event)
     // 销毁控制面板
     destroyControlPanel();
     saveConfiguration();
+    // 平时的保存是延迟、后台写盘的；关闭时必须落盘
+    configManager->flush();
     event->accept();
 }
 
@@ -35,6 +39,9 @@ void ImageWidget::loadConfiguration()
     currentConfig.lastViewMode = config.lastViewMode;
     currentConfig.lastImageIndex = config.lastImageIndex;
     currentConfig.lastImagePath = config.lastImagePath;
+    currentConfig.sortMode = config.sortMode;
+    currentConfig.sortDescending = config.sortDescending;
+    currentConfig.thumbnailCacheLimitMB = config.thumbnailCacheLimitMB;
 
     applyConfiguration(config);
 }
@@ -63,6 +70,13 @@ void ImageWidget::saveConfiguration()
     config.lastImageIndex = currentImageIndex;
     config.lastImagePath = currentImagePath;
 
+    // 排序方式
+    config.sortMode = imageSorter.mode();
+    config.sortDescending = imageSorter.isDescending();
+
+    // 缓存上限只能在配置文件里修改，原样保留
+    config.thumbnailCacheLimitMB = currentConfig.thumbnailCacheLimitMB;
+
     configManager->saveConfig(config);
     qDebug() << "保存配置：透明背景 =" << config.transparentBackground;
 }
@@ -154,6 +168,14 @@ void ImageWidget::applyConfiguration(const ConfigManager::Config &config)
         qDebug() << "应用配置：窗口最大化";
     }
 
+    // 排序方式需要在加载图片列表之前设置
+    setSortMode(static_cast<ImageSorter::SortMode>(qBound(0, config.sortMode, int(ImageSorter::SortByExifDate))),
+                config.sortDescending);
+
+    // 缩略图磁盘缓存：按配置的上限在空闲线程池统计并清理
+    ThumbnailDiskCache::setSizeLimit(qint64(qMax(0, config.thumbnailCacheLimitMB)) * 1024 * 1024);
+    ThumbnailDiskCache::pruneAsync();
+
     // 恢复上次打开的图片路径（但不自动加载，避免覆盖当前状态）
     if (!config.lastImagePath.isEmpty() && QFile::exists(config.lastImagePath)) {
         currentImagePath = config.lastImagePath;
@@ -226,11 +248,9 @@ void ImageWidget::toggleAlwaysOnTop()
                 qDebug() << "置顶切换后延迟再次生成掩码";
 
 #ifdef Q_OS_LINUX
-                // 同步 X11 请求，确保处理完毕
-                Display *display = XOpenDisplay(nullptr);
-                if (display) {
+                // 同步 X11 请求，确保处理完毕（必须是 Qt 自己的连接，另开连接同步不到 Qt 的请求）
+                if (Display *display = X11Display::get()) {
                     XSync(display, False);
-                    XCloseDisplay(display);
                 }
 #endif
             }
@@ -269,9 +289,11 @@ bool ImageWidget::hasTransparentBackground() const
 void ImageWidget::restartApplication()
 {
     saveConfiguration();  // 确保最新设置已保存
+    configManager->flush();   // 新进程启动时就会读取，不能等延迟写盘
 
     QString appPath = QCoreApplication::applicationFilePath();
-    QStringList args;
+    // 旧进程退出前仍在监听单实例套接字，新进程必须跳过转发
+    QStringList args{"--new-instance"};
 
     // 如果当前有打开的图片，将图片路径作为参数传递给新实例
     if (!currentImagePath.isEmpty() && QFile::exists(currentImagePath)) {
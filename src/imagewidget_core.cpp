@@ -16,9 +16,11 @@ ImageWidget::ImageWidget(QWidget *parent) : QWidget(parent),
     currentImageIndex(-1),
     isSlideshowActive(false),
     slideshowInterval(3000),
+    imageCache(sharedImageCache().images),
     currentViewMode(ThumbnailView),
     thumbnailSize(150, 150),
     thumbnailSpacing(10),
+    cacheMutex(sharedImageCache().mutex),
     currentViewStateType(FitToWindow),
     mouseInImage(false),
     showNavigationHints(true),
@@ -35,13 +37,18 @@ ImageWidget::ImageWidget(QWidget *parent) : QWidget(parent),
     rotationAngle(0),
     isHorizontallyFlipped(false),
     isVerticallyFlipped(false),
+    exifTransformation(QImageIOHandler::TransformationNone),
     isArchiveMode(false),
-    m_transparentBackgroundReady(false)
+    m_transparentBackgroundReady(false),
+    perfHud(nullptr)
 
 {
+    ++sharedImageCache().windowCount;
 
     // 创建缩略图部件 - 使用统一的构造函数
     thumbnailWidget = new ThumbnailWidget(this, this);  // imageWidget, parent
+    // 缩略图视图下本窗口自身可能完全被遮住而不重绘，第一帧以缩略图部件的绘制为准
+    thumbnailWidget->installEventFilter(this);
     // // 创建缩略图部件
     // thumbnailWidget = new ThumbnailWidget(this);
 
@@ -77,14 +84,35 @@ ImageWidget::ImageWidget(QWidget *parent) : QWidget(parent),
 
     mainLayout->addWidget(scrollArea);
 
+    // 目录实时监视
+    folderWatcher = new FolderWatcher(this);
+    connect(folderWatcher, &FolderWatcher::filesWritten, this,
+            &ImageWidget::onWatchedFilesWritten);
+    connect(folderWatcher, &FolderWatcher::filesRemoved, this,
+            &ImageWidget::onWatchedFilesRemoved);
+    connect(folderWatcher, &FolderWatcher::fileRenamed, this,
+            &ImageWidget::onWatchedFileRenamed);
+    connect(folderWatcher, &FolderWatcher::rescanRequired, this,
+            &ImageWidget::onWatchedFolderRescan);
+
+    // 掩码合并更新：一帧内多次平移只重新计算、提交一次形状
+    maskUpdateTimer.setSingleShot(true);
+    maskUpdateTimer.setInterval(16);
+    connect(&maskUpdateTimer, &QTimer::timeout, this, [this]() {
+        if (m_maskDirty) updateMask();
+    });
+
+    // 性能浮层（默认隐藏，F12 切换）
+    perfHud = new PerfHud(this);
+
     // 启用拖拽功能
     setAcceptDrops(true);
 
     // 加载配置
     loadConfiguration();
 
-    // 创建快捷键动作
-    createShortcutActions();
+    // 创建快捷键动作：窗口显示之前按不到，放到第一帧之后
+    runAfterFirstPaint([this]() { createShortcutActions(); });
 
     setFocusPolicy(Qt::StrongFocus);
 
@@ -102,6 +130,10 @@ ImageWidget::ImageWidget(QWidget *parent) : QWidget(parent),
 
 ImageWidget::~ImageWidget()
 {
+    // 通知仍在运行的后台任务尽快退出
+    prefetchGeneration.advance();
+    thumbnailWidget->stopLoading();
+
     // 确保销毁控制面板
     destroyControlPanel();
 
@@ -109,6 +141,18 @@ ImageWidget::~ImageWidget()
     // delete thumbnailWidget;     // ⚠️ 有父对象，Qt 会自动删除
     // delete scrollArea;          // ⚠️ 有父对象，Qt 会自动删除
     delete configManager;
+
+    // 最后一个窗口关闭时释放共用的原图缓存：QPixmap 不能留到 QApplication 析构之后
+    if (--sharedImageCache().windowCount == 0) {
+        QMutexLocker locker(&cacheMutex);
+        clearCachedImages(imageCache);
+    }
+}
+
+ImageWidget::SharedImageCache &ImageWidget::sharedImageCache()
+{
+    static SharedImageCache *instance = new SharedImageCache;   // 不析构：生命周期由窗口计数管理
+    return *instance;
 }
 
 void ImageWidget::setCurrentDir(const QDir &dir)
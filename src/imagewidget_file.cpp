@@ -95,7 +95,7 @@ void ImageWidget::saveImage()
         QStandardPaths::writableLocation(QStandardPaths::PicturesLocation),
         "Images (*.png *.jpg *.bmp *.jpeg *.webp)");
     if (!fileName.isEmpty()) {
-        if (pixmap.save(fileName)) {
+        if (orientedPixmap().save(fileName)) {
             // 保存成功
         } else {
             // 保存失败
@@ -107,7 +107,7 @@ void ImageWidget::copyImageToClipboard()
 {
     if (!pixmap.isNull()) {
         QClipboard *clipboard = QApplication::clipboard();
-        clipboard->setPixmap(pixmap);
+        clipboard->setPixmap(orientedPixmap());
     }
 }
 
@@ -120,6 +120,10 @@ void ImageWidget::pasteImageFromClipboard()
         QImage image = clipboard->image();
         if (!image.isNull()) {
             pixmap = QPixmap::fromImage(image);
+            exifTransformation = QImageIOHandler::TransformationNone;
+            rotationAngle = 0;
+            isHorizontallyFlipped = false;
+            isVerticallyFlipped = false;
             scaleFactor = 1.0;
             panOffset = QPointF(0, 0);
             currentImagePath.clear();
@@ -153,24 +157,57 @@ void ImageWidget::openImageInNewWindow()
         return;
     }
 
-    QString program = QCoreApplication::applicationFilePath();
-    QStringList arguments;
-    arguments << path;
-    QString workingDir = QCoreApplication::applicationDirPath();
-
-    qint64 pid = 0;
-    bool success = QProcess::startDetached(program, arguments, workingDir, &pid);
-    if (!success) {
-#ifdef Q_OS_LINUX
-        QString command = QString("\"%1\" \"%2\"").arg(program, path);
-        success = QProcess::startDetached("/bin/sh", QStringList() << "-c" << command, workingDir, &pid);
-#endif
-    }
+    // 同一进程内开窗口：不重新加载翻译和配置，原图/缩略图缓存直接命中
+    openWindow(path);
+}
 
-    if (!success) {
-        QMessageBox::critical(this, tr("启动失败"),
-                              tr("无法启动新窗口。\n请检查程序路径：\n%1").arg(program));
+void ImageWidget::openPath(const QString &path)
+{
+    if (QFileInfo(path).isDir()) {
+        setCurrentDir(QDir(path));
+        loadImageList();
     } else {
-        qDebug() << "新窗口已启动，PID:" << pid;
+        loadImage(path);
+        switchToSingleView();
+    }
+}
+
+ImageWidget *ImageWidget::openWindow(const QString &path)
+{
+    PV_TRACE_SCOPE_CAT("openWindow", "app");
+    ImageWidget *window = new ImageWidget;
+    window->setAttribute(Qt::WA_DeleteOnClose);
+    const QFileInfo info(path);
+    if (!path.isEmpty() && info.isFile() && !ArchiveHandler::isSupportedArchive(path)) {
+        // 单张图片：先查各窗口共享的原图缓存；未命中时与启动时一样在 CPU 池解码，窗口先显示出来
+        const QString filePath = info.absoluteFilePath();
+        QPixmap cachedPixmap;
+        QImageIOHandler::Transformations transformation;
+        if (window->findCachedImage(filePath, false, cachedPixmap, transformation)) {
+            window->showLoadedPixmap(cachedPixmap, transformation, filePath);
+            window->switchToSingleView();
+        } else {
+            const QString pathBefore = window->currentImagePath;
+            auto *watcher = new QFutureWatcher<DecodedImage>(window);
+            connect(watcher, &QFutureWatcher<DecodedImage>::finished, window, [window, watcher, pathBefore]() {
+                DecodedImage decoded = watcher->result();
+                watcher->deleteLater();
+                // 解码期间用户已经打开了别的图片/目录，就不再覆盖
+                if (window->currentImagePath != pathBefore) return;
+                if (window->loadDecodedImage(std::move(decoded))) {
+                    window->switchToSingleView();
+                }
+            });
+            watcher->setFuture(QtConcurrent::run(ThreadPools::cpu(), &ImageWidget::decodeImageFile, filePath));
+        }
+    } else if (!path.isEmpty() && info.exists()) {
+        window->openPath(path);
     }
+    // 配置里保存的是上一个窗口的位置，错开一点避免完全重叠
+    window->move(window->pos() + QPoint(32, 32));
+    window->show();
+    window->raise();
+    window->activateWindow();
+    qCDebug(lcApp) << "新窗口:" << path;
+    return window;
 }
@@ -8,6 +8,7 @@
 #include <QMimeData>
 #include <QUrl>
 #include "platform_compat.h"
+#include "exifreader.h"
 
 #ifdef _WIN32
 #include <shellapi.h>
@@ -28,64 +29,126 @@ bool ImageWidget::moveFileToRecycleBin(const QString &filePath)
 
 bool ImageWidget::loadImage(const QString &filePath, bool fromCache)
 {
-    qDebug() << "=== loadImage 开始 ===";
-    qDebug() << "文件路径:" << filePath;
+    PV_TRACE_SCOPE_CAT("loadImage", "decode");
+    qCDebug(lcDecode) << "=== loadImage 开始 ===";
+    qCDebug(lcDecode) << "文件路径:" << filePath;
 
 
 
     // 检查文件是否存在
     QFileInfo fileInfo(filePath);
     if (!fileInfo.exists()) {
-        qDebug() << "错误: 文件不存在";
+        qCDebug(lcDecode) << "错误: 文件不存在";
         return false;
     }
 
-    qDebug() << "文件大小:" << fileInfo.size() << "字节";
+    qCDebug(lcDecode) << "文件大小:" << fileInfo.size() << "字节";
 
     // 检查是否是压缩包
     if (ArchiveHandler::isSupportedArchive(filePath)) {
-        qDebug() << "检测为压缩包文件";
+        qCDebug(lcDecode) << "检测为压缩包文件";
         return openArchive(filePath);
     }
 
     // 如果是压缩包模式，从压缩包加载
     if (isArchiveMode) {
-        qDebug() << "压缩包模式，从压缩包加载";
-        return loadImageFromArchive(filePath);
+        qCDebug(lcDecode) << "压缩包模式，从压缩包加载";
+        return loadImageFromArchive(filePath, fromCache);
     }
 
     //QFileInfo fileInfo(filePath);
-    qDebug() << "文件是否存在:" << fileInfo.exists();
-    qDebug() << "文件大小:" << fileInfo.size();
-    qDebug() << "文件权限:" << fileInfo.permissions();
+    qCDebug(lcDecode) << "文件是否存在:" << fileInfo.exists();
+    qCDebug(lcDecode) << "文件大小:" << fileInfo.size();
+    qCDebug(lcDecode) << "文件权限:" << fileInfo.permissions();
 
     if (!fileInfo.exists()) {
-        qDebug() << "错误: 文件不存在";
+        qCDebug(lcDecode) << "错误: 文件不存在";
         return false;
     }
 
-    // 直接加载，绕过缓存进行测试
-    QPixmap loadedPixmap;
-    qDebug() << "开始加载图片...";
+    // 幻灯片/翻页时先查预加载的原图缓存，命中就不再读盘解码
+    if (fromCache) {
+        QPixmap cachedPixmap;
+        QImageIOHandler::Transformations transformation;
+        if (findCachedImage(filePath, false, cachedPixmap, transformation)) {
+            qCDebug(lcDecode) << "命中原图缓存";
+            return showLoadedPixmap(cachedPixmap, transformation, filePath);
+        }
+    }
 
-    if (!loadedPixmap.load(filePath)) {
-        qDebug() << "错误: 直接加载失败";
+    return loadDecodedImage(decodeImageFile(filePath));
+}
 
-        // 尝试使用 QImage 加载
-        QImage image;
-        if (image.load(filePath)) {
-            qDebug() << "使用 QImage 加载成功";
-            loadedPixmap = QPixmap::fromImage(image);
-        } else {
-            qDebug() << "错误: QImage 加载也失败";
-            return false;
-        }
+bool ImageWidget::findCachedImage(const QString &cacheKey, bool fromArchive,
+                                  QPixmap &cachedPixmap, QImageIOHandler::Transformations &transformation)
+{
+    {
+        QMutexLocker locker(&cacheMutex);
+        cachedPixmap = (fromArchive ? archiveImageCache : imageCache).value(cacheKey);
+    }
+    if (cachedPixmap.isNull()) {
+        Metrics::cacheMiss(Metrics::ImageTier);
+        return false;
+    }
+
+    auto it = prefetchedTransformations.constFind(cacheKey);
+    if (it != prefetchedTransformations.constEnd()) {
+        transformation = it.value();
+    } else if (!fromArchive) {
+        // 其他窗口或参考图放进共享缓存的条目：只读文件头 64KB 取 EXIF 方向
+        transformation = ExifReader::transformation(ExifReader::read(cacheKey).orientation);
     } else {
-        qDebug() << "直接加载成功，图片尺寸:" << loadedPixmap.size();
+        // 压缩包条目拿不到方向就按未命中处理，重新解压解码
+        Metrics::cacheMiss(Metrics::ImageTier);
+        return false;
+    }
+    Metrics::cacheHit(Metrics::ImageTier);
+    return true;
+}
+
+ImageWidget::DecodedImage ImageWidget::decodeImageFile(const QString &filePath)
+{
+    PV_TRACE_SCOPE_CAT("decodeImageFile", "decode");
+    DecodedImage decoded;
+    decoded.path = filePath;
+
+    // 按文件头选择解码器，只解码一次；已知的坏文件直接跳过
+    if (FormatSniffer::hasDecodeFailed(filePath)) {
+        qCDebug(lcDecode) << "错误: 该文件之前解码失败过";
+        return decoded;
     }
 
+    FormatSniffer::Format format = FormatSniffer::detect(filePath);
+    QImageReader reader(filePath, FormatSniffer::decoderFormat(format));
+    // EXIF 方向只记录下来，绘制时再施加，不在解码时旋转整图
+    reader.setAutoTransform(false);
+    qCDebug(lcDecode) << "开始加载图片... 格式:" << reader.format();
+
+    if (!reader.read(&decoded.image)) {
+        qCDebug(lcDecode) << "错误: 加载失败" << reader.errorString();
+        FormatSniffer::markDecodeFailed(filePath);
+        return decoded;
+    }
+    decoded.transformation = reader.transformation();
+    return decoded;
+}
+
+bool ImageWidget::loadDecodedImage(DecodedImage decoded)
+{
+    if (decoded.image.isNull()) {
+        return false;
+    }
+    return showLoadedPixmap(QPixmap::fromImage(std::move(decoded.image)), decoded.transformation, decoded.path);
+}
+
+bool ImageWidget::showLoadedPixmap(const QPixmap &loadedPixmap, QImageIOHandler::Transformations transformation,
+                                   const QString &filePath)
+{
+    const QFileInfo fileInfo(filePath);
+    qCDebug(lcDecode) << "加载成功，图片尺寸:" << loadedPixmap.size();
+
     if (loadedPixmap.isNull()) {
-        qDebug() << "错误: 加载后的 pixmap 为空";
+        qCDebug(lcDecode) << "错误: 加载后的 pixmap 为空";
         return false;
     }
 
@@ -97,16 +160,10 @@ bool ImageWidget::loadImage(const QString &filePath, bool fromCache)
         isVerticallyFlipped = false;
     }
 
-    // 保存原始图片
-    originalPixmap = loadedPixmap;
-
-    // 如果锁定状态，需要重新应用变换
-    if (transformLocked) {
-        applyTransformations();
-    } else {
-        pixmap = loadedPixmap;
-    }
-    qDebug() << "图片设置完成";
+    // 锁定状态下保留用户的旋转/镜像，绘制时与新图片的 EXIF 方向一起施加
+    pixmap = loadedPixmap;
+    exifTransformation = transformation;
+    qCDebug(lcDecode) << "图片设置完成";
 
 
 
@@ -124,66 +181,64 @@ bool ImageWidget::loadImage(const QString &filePath, bool fromCache)
     }
 
     currentImagePath = filePath;
-    qDebug() << "当前图片路径设置为:" << currentImagePath;
+    qCDebug(lcDecode) << "当前图片路径设置为:" << currentImagePath;
 
     // 检查目录是否改变
     bool dirChanged = (currentDir != fileInfo.absoluteDir());
     if (dirChanged) {
         currentDir = fileInfo.absoluteDir();
-        loadImageList();
+        if (m_firstPaintDone) {
+            loadImageList();
+        } else {
+            // 窗口还没画过（启动或新窗口）：先显示图片，目录扫描和缩略图放到第一帧之后
+            runAfterFirstPaint([this, filePath, dir = currentDir]() {
+                if (currentDir != dir) return;   // 之后已切换目录并重新扫描
+                loadImageList();
+                if (currentImagePath == filePath) {
+                    currentImageIndex = imageList.indexOf(QFileInfo(filePath).fileName());
+                }
+                updateWindowTitle();
+            });
+        }
     }
 
     // 确保当前图片索引正确设置
     currentImageIndex = imageList.indexOf(fileInfo.fileName());
-    qDebug() << "当前图片索引:" << currentImageIndex;
+    qCDebug(lcDecode) << "当前图片索引:" << currentImageIndex;
 
     update();
     updateWindowTitle();
-    qDebug() << "=== loadImage 完成 ===";
+    qCDebug(lcDecode) << "=== loadImage 完成 ===";
 
     return true;
 }
 
 void ImageWidget::loadImageList()
 {
-    QStringList newImageList;
-
-    QFileInfoList fileList = currentDir.entryInfoList(QDir::Files);
-    QStringList imageFilters = {"*.png",  "*.jpg", "*.bmp",  "*.jpeg",
-                                "*.webp", "*.gif", "*.tiff", "*.tif"};
-    QStringList archiveFilters = {"*.zip", "*.rar", "*.7z", "*.tar",
-                                  "*.gz",  "*.bz2"}; // 添加压缩包过滤器
-
-    foreach (const QFileInfo &fileInfo, fileList) {
-        bool isImage = false;
-        foreach (const QString &filter, imageFilters) {
-            if (fileInfo.fileName().endsWith(filter.mid(1), Qt::CaseInsensitive)) {
-                newImageList.append(fileInfo.fileName());
-                isImage = true;
-                break;
-            }
-        }
+    PV_TRACE_SCOPE_CAT("loadImageList", "scan");
+    // 目录内容重新扫描，之前的预加载和 EXIF 读取任务作废
+    prefetchGeneration.advance();
+    exifGeneration.advance();
 
-        // 如果不是图片，检查是否是压缩包
-        if (!isImage) {
-            foreach (const QString &filter, archiveFilters) {
-                if (fileInfo.fileName().endsWith(filter.mid(1),
-                                                 Qt::CaseInsensitive)) {
-                    newImageList.append(fileInfo.fileName());
-                    break;
-                }
-            }
-        }
-    }
-
-    newImageList.sort();
+    QStringList newImageList = DirectoryScanner::scan(currentDir, imageSorter);
 
     // 只有当文件列表实际发生变化时才更新和输出日志
     if (newImageList != imageList) {
         imageList = newImageList;
         thumbnailWidget->setImageList(imageList, currentDir);
-        qDebug() << "找到文件:" << imageList.size() << "个（包含图片和压缩包）";
+        qCDebug(lcDecode) << "找到文件:" << imageList.size() << "个（包含图片和压缩包）";
     }
+    requestExifSortKeys();
+
+    // 之后的文件变化通过目录监视增量更新，无需重新扫描
+    folderWatcher->watch(currentDir.absolutePath());
+}
+
+// 是否应该出现在列表中（图片或压缩包）
+// 没有扩展名的文件按文件头识别
+bool ImageWidget::isListableFile(const QString &fileName) const
+{
+    return DirectoryScanner::isListable(currentDir.absoluteFilePath(fileName));
 }
 
 bool ImageWidget::loadImageByIndex(int index, bool fromCache)
@@ -197,7 +252,7 @@ bool ImageWidget::loadImageByIndex(int index, bool fromCache)
     if (isArchiveMode) {
         // 压缩包模式：使用内部文件名
         QString imagePath = imageList.at(index);
-        result = loadImageFromArchive(imagePath);
+        result = loadImageFromArchive(imagePath, fromCache);
 
         // 更新当前图片路径为压缩包路径 + 内部文件路径
         if (result) {
@@ -221,40 +276,7 @@ bool ImageWidget::loadImageByIndex(int index, bool fromCache)
         // 预加载下一张图片（用于幻灯片）
         if (isSlideshowActive) {
             int nextIndex = (currentImageIndex + 1) % imageList.size();
-
-            if (isArchiveMode) {
-                // 压缩包模式预加载
-                QString nextPath = imageList.at(nextIndex);
-                if (!archiveImageCache.contains(nextPath)) {
-                    QtConcurrent::run([this, nextIndex]() {
-                        QString nextPath = imageList.at(nextIndex);
-                        QByteArray imageData = archiveHandler.extractFile(nextPath);
-                        if (!imageData.isEmpty()) {
-                            QPixmap tempPixmap;
-                            if (tempPixmap.loadFromData(imageData)) {
-                                QMutexLocker locker(&cacheMutex);
-                                archiveImageCache.insert(nextPath, tempPixmap);
-                                qDebug() << "预加载压缩包图片:" << nextPath;
-                            }
-                        }
-                    });
-                }
-            } else {
-                // 普通文件模式预加载
-                QString nextPath =
-                    currentDir.absoluteFilePath(imageList.at(nextIndex));
-                if (!imageCache.contains(nextPath)) {
-                    QtConcurrent::run([this, nextIndex]() {
-                        QString nextPath =
-                            currentDir.absoluteFilePath(imageList.at(nextIndex));
-                        QPixmap tempPixmap;
-                        if (tempPixmap.load(nextPath)) {
-                            QMutexLocker locker(&cacheMutex);
-                            imageCache.insert(nextPath, tempPixmap);
-                        }
-                    });
-                }
-            }
+            prefetchImage(nextIndex);
         }
     }
 
@@ -263,64 +285,64 @@ bool ImageWidget::loadImageByIndex(int index, bool fromCache)
 
 void ImageWidget::loadNextImage()
 {
-    qDebug() << "=== loadNextImage 开始 ===";
-    qDebug() << "当前模式:" << (currentViewMode == SingleView ? "单张" : "缩略图");
-    qDebug() << "当前索引:" << currentImageIndex << "，图片总数:" << imageList.size();
+    qCDebug(lcDecode) << "=== loadNextImage 开始 ===";
+    qCDebug(lcDecode) << "当前模式:" << (currentViewMode == SingleView ? "单张" : "缩略图");
+    qCDebug(lcDecode) << "当前索引:" << currentImageIndex << "，图片总数:" << imageList.size();
 
     if (imageList.isEmpty()) {
-        qDebug() << "图片列表为空，返回";
+        qCDebug(lcDecode) << "图片列表为空，返回";
         return;
     }
 
     int nextIndex = (currentImageIndex + 1) % imageList.size();
-    qDebug() << "计算出的下一个索引:" << nextIndex;
+    qCDebug(lcDecode) << "计算出的下一个索引:" << nextIndex;
 
     if (currentViewMode == SingleView) {
-        qDebug() << "单张模式，加载图片";
+        qCDebug(lcDecode) << "单张模式，加载图片";
         loadImageByIndex(nextIndex, true);
     } else {
         // 缩略图模式下，只更新索引和选中状态
-        qDebug() << "缩略图模式，更新选中状态";
+        qCDebug(lcDecode) << "缩略图模式，更新选中状态";
         currentImageIndex = nextIndex;
         thumbnailWidget->setSelectedIndex(currentImageIndex);
         thumbnailWidget->ensureVisible(currentImageIndex);
         updateWindowTitle();
 
-        qDebug() << "更新后的当前索引:" << currentImageIndex;
+        qCDebug(lcDecode) << "更新后的当前索引:" << currentImageIndex;
     }
 
-    qDebug() << "=== loadNextImage 结束 ===";
+    qCDebug(lcDecode) << "=== loadNextImage 结束 ===";
 }
 
 void ImageWidget::loadPreviousImage()
 {
-    qDebug() << "=== loadPreviousImage 开始 ===";
-    qDebug() << "当前模式:" << (currentViewMode == SingleView ? "单张" : "缩略图");
-    qDebug() << "当前索引:" << currentImageIndex << "，图片总数:" << imageList.size();
+    qCDebug(lcDecode) << "=== loadPreviousImage 开始 ===";
+    qCDebug(lcDecode) << "当前模式:" << (currentViewMode == SingleView ? "单张" : "缩略图");
+    qCDebug(lcDecode) << "当前索引:" << currentImageIndex << "，图片总数:" << imageList.size();
 
     if (imageList.isEmpty()) {
-        qDebug() << "图片列表为空，返回";
+        qCDebug(lcDecode) << "图片列表为空，返回";
         return;
     }
 
     int prevIndex = (currentImageIndex - 1 + imageList.size()) % imageList.size();
-    qDebug() << "计算出的上一个索引:" << prevIndex;
+    qCDebug(lcDecode) << "计算出的上一个索引:" << prevIndex;
 
     if (currentViewMode == SingleView) {
-        qDebug() << "单张模式，加载图片";
+        qCDebug(lcDecode) << "单张模式，加载图片";
         loadImageByIndex(prevIndex, true);
     } else {
         // 缩略图模式下，只更新索引和选中状态
-        qDebug() << "缩略图模式，更新选中状态";
+        qCDebug(lcDecode) << "缩略图模式，更新选中状态";
         currentImageIndex = prevIndex;
         thumbnailWidget->setSelectedIndex(currentImageIndex);
         thumbnailWidget->ensureVisible(currentImageIndex);
         updateWindowTitle();
 
-        qDebug() << "更新后的当前索引:" << currentImageIndex;
+        qCDebug(lcDecode) << "更新后的当前索引:" << currentImageIndex;
     }
 
-    qDebug() << "=== loadPreviousImage 结束 ===";
+    qCDebug(lcDecode) << "=== loadPreviousImage 结束 ===";
 }
 
 void ImageWidget::dragEnterEvent(QDragEnterEvent *event)
@@ -422,12 +444,12 @@ void ImageWidget::performDeleteCurrentImage()
     int indexToDelete = currentImageIndex;
 
     if (moveFileToRecycleBin(imageToDelete)) {
-        imageCache.remove(imageToDelete);
+        removeCachedImage(imageCache, imageToDelete);
         ThumbnailWidget::clearThumbnailCacheForImage(imageToDelete);
 
         if (indexToDelete >= 0 && indexToDelete < imageList.size()) {
-            imageList.removeAt(indexToDelete);
-            thumbnailWidget->setImageList(imageList, currentDir);
+            imageSorter.removeFile(imageList.takeAt(indexToDelete));
+            thumbnailWidget->removeImage(indexToDelete);
 
             if (imageList.isEmpty()) {
                 pixmap = QPixmap();
@@ -90,7 +90,11 @@ void ImageWidget::keyPressEvent(QKeyEvent *event)
             break;
         case Qt::Key_PageUp:
             // PageUp：增加透明度（变得更不透明）
-            {
+            // 覆盖层存在时只调整图片本身的不透明度，只重绘图片区域
+            if (canvasOverlay) {
+                canvasOverlay->setImageOpacity(canvasOverlay->imageOpacity() + 0.1);
+                event->accept();
+            } else {
                 double currentOpacity = windowOpacity();
                 double newOpacity = qMin(1.0, currentOpacity + 0.1);
                 setWindowOpacity(newOpacity);
@@ -99,7 +103,10 @@ void ImageWidget::keyPressEvent(QKeyEvent *event)
             break;
         case Qt::Key_PageDown:
             // PageDown：减少透明度（变得更透明）
-            {
+            if (canvasOverlay) {
+                canvasOverlay->setImageOpacity(qMax(0.1, canvasOverlay->imageOpacity() - 0.1));
+                event->accept();
+            } else {
                 double currentOpacity = windowOpacity();
                 double newOpacity = qMax(0.1, currentOpacity - 0.1);
                 setWindowOpacity(newOpacity);
@@ -5,7 +5,6 @@
 #include <QMessageBox>
 #include <QClipboard>
 #include <QApplication>
-#include <QProcess>
 #include "platform_compat.h"
 
 void ImageWidget::showContextMenu(const QPoint &globalPos)
@@ -150,10 +149,7 @@ void ImageWidget::showContextMenu(const QPoint &globalPos)
             [this, getCurrentImagePath]() {  // 按值捕获 getCurrentImagePath
                 QString path = getCurrentImagePath();
                 if (!path.isEmpty() && QFile::exists(path)) {
-                    QString program = QCoreApplication::applicationFilePath();
-                    QStringList arguments;
-                    arguments << path;
-                    QProcess::startDetached(program, arguments);
+                    openWindow(path);
                 } else {
                     QMessageBox::warning(this, tr("警告"), tr("没有可用的图片文件"));
                 }
@@ -290,6 +286,9 @@ void ImageWidget::showContextMenu(const QPoint &globalPos)
             connect(canvasModeAction, &QAction::triggered, this,
                     &ImageWidget::toggleCanvasMode);
         }
+
+        // 参考图板
+        populateReferenceMenu(windowshowMenu->addMenu(tr("参考图板")));
     }
 
     // 幻灯片菜单
@@ -326,6 +325,40 @@ void ImageWidget::showContextMenu(const QPoint &globalPos)
     connect(interval5s, &QAction::triggered, [this]() { setSlideshowInterval(5000); });
     connect(interval10s, &QAction::triggered, [this]() { setSlideshowInterval(10000); });
 
+    // 排序菜单：切换排序方式只重排已有列表，不重新扫描目录
+    QMenu *sortMenu = contextMenu.addMenu(tr("排序方式"));
+    QAction *sortByName = sortMenu->addAction(tr("名称（自然排序）"));
+    QAction *sortByTime = sortMenu->addAction(tr("修改时间"));
+    QAction *sortBySize = sortMenu->addAction(tr("文件大小"));
+    QAction *sortByExif = sortMenu->addAction(tr("拍摄日期 (EXIF)"));
+    sortMenu->addSeparator();
+    QAction *sortDescending = sortMenu->addAction(tr("倒序"));
+
+    sortByName->setCheckable(true);
+    sortByTime->setCheckable(true);
+    sortBySize->setCheckable(true);
+    sortByExif->setCheckable(true);
+    sortDescending->setCheckable(true);
+
+    ImageSorter::SortMode sortMode = imageSorter.mode();
+    bool descending = imageSorter.isDescending();
+    sortByName->setChecked(sortMode == ImageSorter::SortByName);
+    sortByTime->setChecked(sortMode == ImageSorter::SortByModifiedTime);
+    sortBySize->setChecked(sortMode == ImageSorter::SortBySize);
+    sortByExif->setChecked(sortMode == ImageSorter::SortByExifDate);
+    sortDescending->setChecked(descending);
+
+    // 压缩包内只有文件名可用
+    sortByTime->setEnabled(!isArchiveMode);
+    sortBySize->setEnabled(!isArchiveMode);
+    sortByExif->setEnabled(!isArchiveMode);
+
+    connect(sortByName, &QAction::triggered, [this, descending]() { setSortMode(ImageSorter::SortByName, descending); });
+    connect(sortByTime, &QAction::triggered, [this, descending]() { setSortMode(ImageSorter::SortByModifiedTime, descending); });
+    connect(sortBySize, &QAction::triggered, [this, descending]() { setSortMode(ImageSorter::SortBySize, descending); });
+    connect(sortByExif, &QAction::triggered, [this, descending]() { setSortMode(ImageSorter::SortByExifDate, descending); });
+    connect(sortDescending, &QAction::triggered, [this, sortMode](bool checked) { setSortMode(sortMode, checked); });
+
     // 帮助菜单
     QMenu *helpMenu = contextMenu.addMenu(tr("帮助"));
     QAction *aboutAction = helpMenu->addAction(tr("关于 (F1)"));
@@ -356,3 +389,74 @@ void ImageWidget::openSelectedImage()
         thumbnailWidget->thumbnailClicked(selectedIndex);
     }
 }
+
+// 参考图板菜单：右键菜单和画布模式控制面板共用
+void ImageWidget::populateReferenceMenu(QMenu *referenceMenu)
+{
+    QAction *pinAction = referenceMenu->addAction(tr("固定当前图片为参考图"));
+    pinAction->setEnabled(!pixmap.isNull());
+    connect(pinAction, &QAction::triggered, this, &ImageWidget::pinCurrentImageAsReference);
+    connect(referenceMenu->addAction(tr("添加参考图...")), &QAction::triggered,
+            this, &ImageWidget::addReferenceImages);
+    QAction *clearReferencesAction =
+        referenceMenu->addAction(tr("清空参考图 (%1)").arg(canvasReferences.size()));
+    clearReferencesAction->setEnabled(!canvasReferences.isEmpty());
+    connect(clearReferencesAction, &QAction::triggered, this, &ImageWidget::clearCanvasReferences);
+
+    // 每张参考图一个子菜单：缩放、摆放位置、不透明度、移除
+    if (!canvasReferences.isEmpty()) {
+        referenceMenu->addSeparator();
+    }
+    for (int i = 0; i < canvasReferences.size(); ++i) {
+        const CanvasOverlay::Reference reference = canvasReferences.at(i);
+        QMenu *itemMenu = referenceMenu->addMenu(tr("参考图 %1").arg(i + 1));
+
+        connect(itemMenu->addAction(tr("放大")), &QAction::triggered, this, [this, i, reference]() {
+            setCanvasReferenceView(i, reference.position, reference.scale * 1.25);
+        });
+        connect(itemMenu->addAction(tr("缩小")), &QAction::triggered, this, [this, i, reference]() {
+            setCanvasReferenceView(i, reference.position, reference.scale * 0.8);
+        });
+        connect(itemMenu->addAction(tr("原始大小")), &QAction::triggered, this, [this, i, reference]() {
+            setCanvasReferenceView(i, reference.position, 1.0);
+        });
+
+        // 覆盖层与主窗口几何一致，按窗口四角摆放
+        QMenu *placeMenu = itemMenu->addMenu(tr("移动到"));
+        const QSize size = reference.rect().size();
+        const int margin = 20;
+        const QList<QPair<QString, QPointF>> places = {
+            { tr("左上角"), QPointF(margin, margin) },
+            { tr("右上角"), QPointF(width() - size.width() - margin, margin) },
+            { tr("左下角"), QPointF(margin, height() - size.height() - margin) },
+            { tr("右下角"), QPointF(width() - size.width() - margin, height() - size.height() - margin) },
+        };
+        for (const auto &place : places) {
+            connect(placeMenu->addAction(place.first), &QAction::triggered, this, [this, i, reference, place]() {
+                setCanvasReferenceView(i, place.second, reference.scale);
+            });
+        }
+
+        QMenu *opacityMenu = itemMenu->addMenu(tr("不透明度"));
+        for (int percent : {100, 75, 50, 25}) {
+            QAction *opacityAction = opacityMenu->addAction(QString("%1%").arg(percent));
+            opacityAction->setCheckable(true);
+            opacityAction->setChecked(qRound(reference.opacity * 100) == percent);
+            connect(opacityAction, &QAction::triggered, this, [this, i, percent]() {
+                setCanvasReferenceOpacity(i, percent / 100.0);
+            });
+        }
+
+        itemMenu->addSeparator();
+        connect(itemMenu->addAction(tr("移除")), &QAction::triggered, this, [this, i]() {
+            removeCanvasReference(i);
+        });
+    }
+}
+
+void ImageWidget::showReferenceMenu(const QPoint &globalPos)
+{
+    QMenu menu;
+    populateReferenceMenu(&menu);
+    menu.exec(globalPos);
+}
@@ -47,7 +47,7 @@ void ImageWidget::mousePressEvent(QMouseEvent *event)
             if (event->button() == Qt::LeftButton) {
                 // ---- 原有的左键处理（可保留或精简） ----
                 if (!pixmap.isNull()) {
-                    QSizeF scaledSize = QSizeF(pixmap.size()) * scaleFactor;
+                    QSizeF scaledSize = QSizeF(displaySize()) * scaleFactor;
                     QPointF offset((width() - scaledSize.width()) / 2.0 + panOffset.x(),
                                    (height() - scaledSize.height()) / 2.0 + panOffset.y());
                     QRectF imageRect(offset, scaledSize);
@@ -96,7 +96,7 @@ void ImageWidget::mouseMoveEvent(QMouseEvent *event)
         panOffset += delta;
         panStartPosition = event->pos();
         update();
-        updateMask();
+        scheduleMaskUpdate();
     }
 }
 
@@ -169,7 +169,7 @@ void ImageWidget::mouseDoubleClickEvent(QMouseEvent *event)
         } else if (currentViewMode == SingleView) {
             // 检查是否在图片区域内，并且不在切换区域
             if (!pixmap.isNull()) {
-                QSize scaledSize = pixmap.size() * scaleFactor;
+                QSize scaledSize = displaySize() * scaleFactor;
                 QPointF offset((width() - scaledSize.width()) / 2 + panOffset.x(),
                                (height() - scaledSize.height()) / 2 + panOffset.y());
                 QRectF imageRect(offset, scaledSize);
@@ -1,6 +1,7 @@
 // imagewidget_shortcuts.cpp
 #include "imagewidget.h"
 #include <QAction>
+#include <QApplication>
 
 void ImageWidget::createShortcutActions()
 {
@@ -119,4 +120,39 @@ void ImageWidget::createShortcutActions()
     connect(openInNewWindowAction, &QAction::triggered, this, &ImageWidget::openImageInNewWindow);
     this->addAction(openInNewWindowAction);
 
+    // 性能浮层：F12
+    QAction *perfHudAction = new QAction(tr("性能浮层"), this);
+    perfHudAction->setShortcut(QKeySequence(Qt::Key_F12));
+    perfHudAction->setShortcutContext(Qt::ApplicationShortcut);
+    connect(perfHudAction, &QAction::triggered, this, &ImageWidget::togglePerfHud);
+    this->addAction(perfHudAction);
+
+    claimApplicationShortcuts();
+}
+
+void ImageWidget::changeEvent(QEvent *event)
+{
+    if (event->type() == QEvent::ActivationChange && isActiveWindow()) {
+        claimApplicationShortcuts();
+    }
+    QWidget::changeEvent(event);
+}
+
+// 多个窗口把同一按键都注册为 ApplicationShortcut 时 Qt 判定为冲突，哪个都不触发。
+// 只让最近激活的窗口持有应用级快捷键（控制面板等独立窗口有焦点时仍可用），
+// 其余窗口降为窗口级，激活时再取回。
+void ImageWidget::claimApplicationShortcuts()
+{
+    static const char *const kDemoted = "pvDemotedShortcut";
+    for (QWidget *widget : QApplication::topLevelWidgets()) {
+        ImageWidget *window = qobject_cast<ImageWidget *>(widget);
+        if (!window) continue;
+        const bool owner = (window == this);
+        for (QAction *action : window->actions()) {
+            if (action->shortcutContext() == Qt::ApplicationShortcut || action->property(kDemoted).toBool()) {
+                action->setShortcutContext(owner ? Qt::ApplicationShortcut : Qt::WindowShortcut);
+                action->setProperty(kDemoted, !owner);
+            }
+        }
+    }
 }
@@ -1,5 +1,7 @@
 // imagewidget_slideshow.cpp
 #include "imagewidget.h"
+#include "exifreader.h"
+#include <QImageReader>
 
 void ImageWidget::startSlideshow()
 {
@@ -46,31 +48,121 @@ void ImageWidget::slideshowNext()
     int nextIndex = (currentImageIndex + 1) % imageList.size();
 
     // 预加载下一张图片（如果不在缓存中）
-    if (!imageCache.contains(currentDir.absoluteFilePath(imageList.at(nextIndex)))) {
-        QtConcurrent::run([this, nextIndex]() {
-            QString nextPath = currentDir.absoluteFilePath(imageList.at(nextIndex));
-            QPixmap tempPixmap;
-            if (tempPixmap.load(nextPath)) {
-                QMutexLocker locker(&cacheMutex);
-                imageCache.insert(nextPath, tempPixmap);
-            }
-        });
-    }
+    prefetchImage(nextIndex);
 
     // 加载当前图片
     loadImageByIndex(nextIndex, true);
 }
 
+// 幻灯片预加载：路径在 GUI 线程确定，后台只解码为 QImage，
+// 回到 GUI 线程再转换为 QPixmap 放入缓存。切换目录/压缩包后旧任务作废。
+void ImageWidget::prefetchImage(int index)
+{
+    if (index < 0 || index >= imageList.size()) return;
+
+    const bool fromArchive = isArchiveMode;
+    const QString cacheKey = fromArchive ? imageList.at(index)
+                                         : currentDir.absoluteFilePath(imageList.at(index));
+    {
+        QMutexLocker locker(&cacheMutex);
+        if ((fromArchive ? archiveImageCache : imageCache).contains(cacheKey)) {
+            Metrics::cacheHit(Metrics::ImageTier);
+            return;
+        }
+    }
+    Metrics::cacheMiss(Metrics::ImageTier);
+
+    const QString archivePath = currentArchivePath;
+    const CancellationToken token = prefetchGeneration.token();
+
+    // 工作线程不捕获 this，不访问 imageList 和界面共用的 archiveHandler
+    // 读取/解压在 I/O 池，解码在 CPU 池，优先级低于可见缩略图、高于后台预热
+    // 缓存里放未旋转的原图，EXIF 方向从同一份数据里顺带解析，显示时再施加
+    struct Prefetched {
+        QImage image;
+        int exifOrientation = 1;
+    };
+    const QString sourcePath = fromArchive ? archivePath + "|" + cacheKey : cacheKey;
+    QFuture<Prefetched> future = QtConcurrent::task([sourcePath, token]() {
+                                     return ThumbnailLoader::readSource(sourcePath, token);
+                                 })
+                                     .onThreadPool(*ThreadPools::io())
+                                     .withPriority(ThreadPools::PriorityNextImage)
+                                     .spawn()
+                                     .then(ThreadPools::cpu(), [sourcePath, token](const QByteArray &data) {
+                                         Prefetched prefetched;
+                                         prefetched.exifOrientation = ExifReader::readFromData(data).orientation;
+                                         prefetched.image = ThumbnailLoader::decodeData(data, sourcePath, token);
+                                         return prefetched;
+                                     });
+
+    auto *watcher = new QFutureWatcher<Prefetched>(this);
+    connect(watcher, &QFutureWatcher<Prefetched>::finished, this, [this, watcher, fromArchive, cacheKey, token]() {
+        Prefetched prefetched = watcher->result();
+        watcher->deleteLater();
+        if (token.isCancelled() || prefetched.image.isNull()) return;
+
+        QMutexLocker locker(&cacheMutex);
+        insertCachedImage(fromArchive ? archiveImageCache : imageCache, cacheKey,
+                          QPixmap::fromImage(std::move(prefetched.image)));
+        prefetchedTransformations.insert(cacheKey, ExifReader::transformation(prefetched.exifOrientation));
+        qCDebug(lcDecode) << "预加载完成:" << cacheKey;
+    });
+    watcher->setFuture(future);
+}
+
+static qint64 pixmapBytes(const QPixmap &pixmap)
+{
+    return qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+}
+
+void ImageWidget::insertCachedImage(QMap<QString, QPixmap> &cache, const QString &key, const QPixmap &pixmap)
+{
+    qint64 delta = pixmapBytes(pixmap);
+    auto it = cache.find(key);
+    if (it != cache.end()) {
+        delta -= pixmapBytes(it.value());
+        it.value() = pixmap;
+    } else {
+        cache.insert(key, pixmap);
+    }
+    Metrics::addCacheBytes(Metrics::ImageTier, delta);
+}
+
+void ImageWidget::removeCachedImage(QMap<QString, QPixmap> &cache, const QString &key)
+{
+    auto it = cache.find(key);
+    if (it == cache.end()) return;
+    Metrics::addCacheBytes(Metrics::ImageTier, -pixmapBytes(it.value()));
+    cache.erase(it);
+    prefetchedTransformations.remove(key);
+}
+
+void ImageWidget::clearCachedImages(QMap<QString, QPixmap> &cache)
+{
+    qint64 bytes = 0;
+    for (const QPixmap &pixmap : std::as_const(cache)) {
+        bytes += pixmapBytes(pixmap);
+    }
+    Metrics::addCacheBytes(Metrics::ImageTier, -bytes);
+    cache.clear();
+    prefetchedTransformations.clear();
+}
+
 void ImageWidget::preloadAllImages()
 {
-    imageCache.clear();
+    clearCachedImages(imageCache);
 
     int loadedCount = 0;
     for (const QString &fileName : imageList) {
         QString filePath = currentDir.absoluteFilePath(fileName);
-        QPixmap tempPixmap;
-        if (tempPixmap.load(filePath)) {
-            imageCache.insert(filePath, tempPixmap);
+        // 与预加载一致：缓存未旋转的原图，方向单独记录
+        QImageReader reader(filePath);
+        reader.setAutoTransform(false);
+        QImage image;
+        if (reader.read(&image)) {
+            insertCachedImage(imageCache, filePath, QPixmap::fromImage(std::move(image)));
+            prefetchedTransformations.insert(filePath, reader.transformation());
             loadedCount++;
             // 移除单条日志消息，减少干扰
         }
@@ -81,7 +173,6 @@ void ImageWidget::preloadAllImages()
 
 void ImageWidget::clearImageCache()
 {
-    int cacheSize = imageCache.size();
-    imageCache.clear();
+    clearCachedImages(imageCache);
     updateWindowTitle();
 }
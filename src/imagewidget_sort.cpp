@@ -0,0 +1,115 @@
+// imagewidget_sort.cpp
+#include "imagewidget.h"
+#include <QFutureWatcher>
+#include <algorithm>
+
+// 与 loadImageList 中 imageSorter.sort() 的顺序保持一致
+int ImageWidget::sortedInsertPosition(const QString &fileName) const
+{
+    auto it = std::lower_bound(imageList.cbegin(), imageList.cend(), fileName,
+                               [this](const QString &a, const QString &b) {
+                                   return imageSorter.lessThan(a, b);
+                               });
+    return static_cast<int>(it - imageList.cbegin());
+}
+
+// 条目的排序键变化后（文件被覆盖）移动到新位置，缩略图随之迁移
+void ImageWidget::moveToSortedPosition(int index)
+{
+    if (index < 0 || index >= imageList.size()) return;
+
+    QString fileName = imageList.takeAt(index);
+    bool wasCurrent = (currentImageIndex == index);
+    if (currentImageIndex > index) {
+        --currentImageIndex;
+    }
+
+    int newIndex = sortedInsertPosition(fileName);
+    imageList.insert(newIndex, fileName);
+    if (wasCurrent) {
+        currentImageIndex = newIndex;
+    } else if (currentImageIndex >= newIndex) {
+        ++currentImageIndex;
+    }
+
+    if (newIndex != index) {
+        thumbnailWidget->renameImage(index, newIndex, fileName);
+    }
+}
+
+void ImageWidget::setSortMode(ImageSorter::SortMode mode, bool descending)
+{
+    currentConfig.sortMode = mode;
+    currentConfig.sortDescending = descending;
+
+    if (mode == imageSorter.mode() && descending == imageSorter.isDescending()) return;
+    imageSorter.setMode(mode, descending);
+
+    if (imageList.isEmpty()) return;
+
+    // 只用缓存的排序键重排，不重新扫描目录，也不重新加载缩略图
+    applySortOrder();
+    requestExifSortKeys();
+
+    qDebug() << "排序方式切换为:" << mode << (descending ? "倒序" : "正序");
+}
+
+void ImageWidget::applySortOrder()
+{
+    QString currentFileName = imageList.value(currentImageIndex);
+    imageSorter.sort(imageList);
+    currentImageIndex = currentFileName.isEmpty() ? -1 : imageList.indexOf(currentFileName);
+
+    if (isArchiveMode) {
+        QStringList thumbnailPaths;
+        for (const QString &fileName : std::as_const(imageList)) {
+            thumbnailPaths.append(currentArchivePath + "|" + fileName);
+        }
+        thumbnailWidget->setImageOrder(thumbnailPaths);
+    } else {
+        thumbnailWidget->setImageOrder(imageList);
+    }
+
+    if (currentViewMode == ThumbnailView && currentImageIndex >= 0) {
+        thumbnailWidget->setSelectedIndex(currentImageIndex);
+    }
+
+    updateWindowTitle();
+}
+
+void ImageWidget::requestExifSortKeys()
+{
+    if (isArchiveMode || imageSorter.mode() != ImageSorter::SortByExifDate) return;
+
+    const QList<QPair<QString, QString>> files = imageSorter.pendingExifFiles();
+    if (files.isEmpty()) return;
+
+    // 新的请求包含所有尚未读取的文件，之前还在读的请求作废
+    exifGeneration.advance();
+    const CancellationToken token = exifGeneration.token();
+
+    QFuture<QHash<QString, qint64>> future = QtConcurrent::task([files, token]() {
+                                                 return ImageSorter::readExifTimes(files, token);
+                                             })
+                                                 .onThreadPool(*ThreadPools::io())
+                                                 .withPriority(ThreadPools::PriorityBackground)
+                                                 .spawn();
+
+    auto *watcher = new QFutureWatcher<QHash<QString, qint64>>(this);
+    connect(watcher, &QFutureWatcher<QHash<QString, qint64>>::finished, this, [this, watcher, token]() {
+        QHash<QString, qint64> times = watcher->result();
+        watcher->deleteLater();
+        if (token.isCancelled() || times.isEmpty()) return;
+
+        imageSorter.setExifTimes(times);
+        if (imageSorter.mode() != ImageSorter::SortByExifDate || isArchiveMode) return;
+
+        // 读到之前按修改时间排的序，顺序有变化才刷新缩略图
+        QStringList sorted = imageList;
+        imageSorter.sort(sorted);
+        if (sorted != imageList) {
+            applySortOrder();
+        }
+    });
+    watcher->setFuture(future);
+}
@@ -46,59 +46,95 @@ void ImageWidget::rotate180()
 
 void ImageWidget::applyTransformations()
 {
-    if (originalPixmap.isNull()) return;
-
-    QTransform transform;
-
-    // 应用镜像变换
-    if (isHorizontallyFlipped || isVerticallyFlipped) {
-        qreal scaleX = isHorizontallyFlipped ? -1.0 : 1.0;
-        qreal scaleY = isVerticallyFlipped ? -1.0 : 1.0;
-        transform.scale(scaleX, scaleY);
-
-        // 调整位置，确保镜像后图片仍然可见
-        if (isHorizontallyFlipped) {
-            transform.translate(-originalPixmap.width(), 0);
-        }
-        if (isVerticallyFlipped) {
-            transform.translate(0, -originalPixmap.height());
-        }
-    }
-
-    // 应用旋转变换
-    if (rotationAngle != 0) {
-        // 移动到中心点旋转
-        transform.translate(originalPixmap.width() / 2.0,
-                            originalPixmap.height() / 2.0);
-        transform.rotate(rotationAngle);
-        transform.translate(-originalPixmap.width() / 2.0,
-                            -originalPixmap.height() / 2.0);
-    }
-
-    // 应用变换
-    pixmap = originalPixmap.transformed(transform, Qt::SmoothTransformation);
+    if (pixmap.isNull()) return;
 
+    // 方向在 paintEvent 中作为坐标变换施加，这里只需要刷新视图
     // 重置平移偏移
     panOffset = QPointF(0, 0);
 
+    updateMask();
     update();
+    syncCanvasOverlay();
 }
 
 void ImageWidget::resetTransform()
 {
-    if (originalPixmap.isNull()) return;
+    if (pixmap.isNull()) return;
 
-    // 重置所有变换状态
+    // 重置所有变换状态（EXIF 方向保留）
     rotationAngle = 0;
     isHorizontallyFlipped = false;
     isVerticallyFlipped = false;
 
-    // 恢复原始图片
-    pixmap = originalPixmap;
     fitToWindow();
     update();
 }
 
+// EXIF 方向的定义是先镜像/翻转再顺时针旋转 90°；垂直翻转等价于水平镜像加旋转 180°，
+// 因此任何方向都可以表示为"是否水平镜像 + 旋转角度"
+static int exifRotation(QImageIOHandler::Transformations exif)
+{
+    return (exif.testFlag(QImageIOHandler::TransformationFlip) ? 180 : 0)
+           + (exif.testFlag(QImageIOHandler::TransformationRotate90) ? 90 : 0);
+}
+
+static bool exifMirrored(QImageIOHandler::Transformations exif)
+{
+    return exif.testFlag(QImageIOHandler::TransformationMirror)
+           != exif.testFlag(QImageIOHandler::TransformationFlip);
+}
+
+QSize ImageWidget::displaySize() const
+{
+    const int angle = (exifRotation(exifTransformation) + rotationAngle) % 360;
+    return (angle % 180 == 0) ? pixmap.size() : pixmap.size().transposed();
+}
+
+QTransform ImageWidget::orientationTransform() const
+{
+    return orientationFor(pixmap.size(), exifTransformation, rotationAngle,
+                          isHorizontallyFlipped, isVerticallyFlipped);
+}
+
+QTransform ImageWidget::orientationFor(const QSize &imageSize, QImageIOHandler::Transformations exif,
+                                       int userRotation, bool horizontalFlip, bool verticalFlip)
+{
+    const QSizeF size = imageSize;
+    const int angle = (exifRotation(exif) + userRotation) % 360;
+
+    // 以图片中心为原点：EXIF 镜像 → 旋转（EXIF + 用户）→ 用户镜像（按显示方向）
+    QTransform transform = QTransform::fromTranslate(-size.width() / 2.0, -size.height() / 2.0);
+    if (exifMirrored(exif)) {
+        transform *= QTransform::fromScale(-1, 1);
+    }
+    transform *= QTransform().rotate(angle);
+    transform *= QTransform::fromScale(horizontalFlip ? -1 : 1, verticalFlip ? -1 : 1);
+
+    // 平移回第一象限，使变换后的图片左上角位于原点
+    const QRectF bounds = transform.mapRect(QRectF(QPointF(0, 0), size));
+    transform *= QTransform::fromTranslate(-bounds.left(), -bounds.top());
+    return transform;
+}
+
+QTransform ImageWidget::imageToWidgetTransform() const
+{
+    const QSizeF scaledSize = QSizeF(displaySize()) * scaleFactor;
+    const QPointF offset((width()  - scaledSize.width())  / 2.0 + panOffset.x(),
+                         (height() - scaledSize.height()) / 2.0 + panOffset.y());
+    return orientationTransform()
+           * QTransform::fromScale(scaleFactor, scaleFactor)
+           * QTransform::fromTranslate(offset.x(), offset.y());
+}
+
+QPixmap ImageWidget::orientedPixmap() const
+{
+    const QTransform transform = orientationTransform();
+    if (pixmap.isNull() || transform.isIdentity()) {
+        return pixmap;
+    }
+    return pixmap.transformed(transform, Qt::SmoothTransformation);
+}
+
 bool ImageWidget::isTransformed() const
 {
     return rotationAngle != 0 || isHorizontallyFlipped || isVerticallyFlipped;
@@ -6,10 +6,15 @@
 #include <QScreen>
 #include <QGuiApplication>
 #include <QGuiApplication>
+#include <QFutureWatcher>
+#include <cmath>
+#include "threadpools.h"
+#include "startuptimer.h"
 
 #ifdef Q_OS_LINUX
 #include <X11/Xlib.h>
 #include <X11/extensions/shape.h>
+#include "x11display.h"
 #endif
 
 #include <execinfo.h>
@@ -17,6 +22,9 @@
 
 void ImageWidget::paintEvent(QPaintEvent *event)
 {
+    PV_TRACE_SCOPE_CAT("imagePaint", "paint");
+    Metrics::FrameScope frameScope;
+    if (!m_firstPaintDone) notifyFirstPaint();
     Q_UNUSED(event);
     QPainter painter(this);
 
@@ -34,39 +42,13 @@ void ImageWidget::paintEvent(QPaintEvent *event)
     }
     if (scaleFactor <= 0) scaleFactor = 1.0;
 
-    // 3. 计算图像在窗口中的缩放后尺寸和偏移
-    QSizeF scaledSize = QSizeF(pixmap.size()) * scaleFactor;
-    QPointF offset((width()  - scaledSize.width())  / 2.0 + panOffset.x(),
-                   (height() - scaledSize.height()) / 2.0 + panOffset.y());
-    QRectF imageCanvasRect(offset, scaledSize);
+    // 3. 原图 → 窗口的变换：EXIF 方向、用户旋转/镜像、缩放和平移都在这里合成，
+    //    旋转不生成整图副本
+    const QTransform view = imageToWidgetTransform();
 
-    // 4. ★ 关键判断：缩放后图片是否大于窗口
-    bool largerThanWindow = (scaledSize.width()  > width() ||
-                             scaledSize.height() > height());
-
-    if (largerThanWindow) {
-        // ---------- 按需渲染：只处理窗口内的可见部分 ----------
-        QRectF visibleRectF = imageCanvasRect.intersected(QRectF(rect()));
-        if (visibleRectF.isEmpty()) return;
-
-        // 映射回原图子矩形
-        QPointF srcTopLeft = (visibleRectF.topLeft() - offset) / scaleFactor;
-        QSizeF  srcSize    = visibleRectF.size() / scaleFactor;
-        QRect sourceRect(srcTopLeft.toPoint(), srcSize.toSize());
-
-        // 缩放可见块
-        QSize targetSize = visibleRectF.size().toSize();
-        QPixmap piece = pixmap.copy(sourceRect)
-                            .scaled(targetSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-        painter.drawPixmap(visibleRectF.topLeft(), piece);
-
-    } else {
-        // ---------- 图片完全在窗口内：直接缩放全图 ----------
-        QPixmap scaledPixmap = pixmap.scaled(scaledSize.toSize(),
-                                             Qt::KeepAspectRatio,
-                                             Qt::SmoothTransformation);
-        painter.drawPixmap(offset, scaledPixmap);
-    }
+    // 4. 按需渲染：只处理窗口内的可见部分（图片完全在窗口内时就是整张原图），
+    //    缩放结果与画布覆盖层共用
+    renderCache.draw(painter, pixmap, view, scaleFactor, rect());
 
     // 5. 变换状态提示（保持不变）
     if (isTransformed()) {
@@ -99,7 +81,7 @@ void ImageWidget::fitToWindow()
         windowSize = desktopRect.size();
     }
 
-    QSize imageSize = pixmap.size();
+    QSize imageSize = displaySize();
     double widthRatio = static_cast<double>(windowSize.width()) / imageSize.width();
     double heightRatio = static_cast<double>(windowSize.height()) / imageSize.height();
 
@@ -108,6 +90,7 @@ void ImageWidget::fitToWindow()
     currentViewStateType = FitToWindow; // 设置为合适大小模式
     updateMask(); //掩码更新
     update();
+    syncCanvasOverlay();
 
 }
 
@@ -145,6 +128,7 @@ void ImageWidget::actualSize()
     currentViewStateType = ActualSize; // 设置为实际大小模式
     updateMask(); //掩码更新
     update();
+    syncCanvasOverlay();
 
 }
 
@@ -170,6 +154,45 @@ void ImageWidget::wheelEvent(QWheelEvent *event)
     // 只重绘，不立即更新掩码
     m_maskDirty = true;   // 标记掩码需要更新
     update();
+    syncCanvasOverlay();
+}
+
+void ImageWidget::togglePerfHud()
+{
+    if (perfHud) perfHud->toggle();
+}
+
+bool ImageWidget::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == thumbnailWidget && event->type() == QEvent::Paint && !m_firstPaintDone) {
+        notifyFirstPaint();
+    }
+    return QWidget::eventFilter(watched, event);
+}
+
+void ImageWidget::notifyFirstPaint()
+{
+    m_firstPaintDone = true;
+    thumbnailWidget->removeEventFilter(this);
+    StartupTimer::finish("firstPaint");
+    if (m_afterFirstPaint.isEmpty()) return;
+    // 本帧画完之后再执行
+    QTimer::singleShot(0, this, [this]() {
+        PV_TRACE_SCOPE_CAT("afterFirstPaint", "startup");
+        const QVector<std::function<void()>> work = std::exchange(m_afterFirstPaint, {});
+        for (const std::function<void()> &item : work) {
+            item();
+        }
+    });
+}
+
+void ImageWidget::runAfterFirstPaint(std::function<void()> work)
+{
+    if (m_firstPaintDone) {
+        QTimer::singleShot(0, this, std::move(work));
+    } else {
+        m_afterFirstPaint.append(std::move(work));
+    }
 }
 
 void ImageWidget::resizeEvent(QResizeEvent *event)
@@ -197,6 +220,7 @@ void ImageWidget::resizeEvent(QResizeEvent *event)
 
 void ImageWidget::updateMask()
 {
+    PV_TRACE_SCOPE_CAT("updateMask", "mask");
     m_maskDirty = false;
 
     // 非单图 / 无图 / 非透明背景 → 清除所有形状
@@ -207,11 +231,9 @@ void ImageWidget::updateMask()
         return;
     }
 
-    // 1. 计算虚拟画布和偏移（与 paintEvent 完全相同）
-    QSizeF scaledSize = QSizeF(pixmap.size()) * scaleFactor;
-    QPointF offset((width()  - scaledSize.width())  / 2.0 + panOffset.x(),
-                   (height() - scaledSize.height()) / 2.0 + panOffset.y());
-    QRectF imageCanvasRect(offset, scaledSize);
+    // 1. 原图 → 窗口的变换（与 paintEvent 完全相同）
+    const QTransform view = imageToWidgetTransform();
+    QRectF imageCanvasRect = view.mapRect(QRectF(pixmap.rect()));
 
     // 2. 只取窗口内可见区域
     QRectF visibleRectF = imageCanvasRect.intersected(QRectF(rect()));
@@ -222,59 +244,73 @@ void ImageWidget::updateMask()
     }
     QRect visibleRect = visibleRectF.toRect();
 
-    // 3. 映射回原图区域（关键：只拷贝这一小块）
-    QPointF srcTopLeft = (visibleRectF.topLeft() - offset) / scaleFactor;
-    QSizeF  srcSize    = visibleRectF.size() / scaleFactor;
-    QRect sourceRect(srcTopLeft.toPoint(), srcSize.toSize());
-
-    QPixmap piece = pixmap.copy(sourceRect);
-    QPixmap scaledPiece = piece.scaled(visibleRect.size(),
-                                       Qt::KeepAspectRatio,
-                                       Qt::SmoothTransformation);
-
-    // 4. 无透明通道 → 直接用矩形（极速）
+    // 3. 无透明通道 → 直接用矩形（极速）
     if (!pixmap.hasAlphaChannel()) {
         setX11ShapeRect(visibleRect);
         return;
     }
 
-    // 5. 有透明通道：缩小到 200x200 以内做逐像素检测（进一步减轻 CPU）
-    const int MAX_MASK_SIZE = 200;   // 减小尺寸，加快速度
-    QPixmap smallMask = scaledPiece;
-    double maskScale = 1.0;
-    if (smallMask.width() > MAX_MASK_SIZE || smallMask.height() > MAX_MASK_SIZE) {
-        maskScale = qMin(MAX_MASK_SIZE / (double)smallMask.width(),
-                         MAX_MASK_SIZE / (double)smallMask.height());
-        smallMask = smallMask.scaled(smallMask.size() * maskScale,
-                                     Qt::KeepAspectRatio,
-                                     Qt::FastTransformation);  // 快速缩放即可
+    // 4. 有透明通道：形状按原图坐标缓存，平移/缩放时只做映射和裁剪
+    const int level = shapeLevelFor(view);
+    if (m_shapeImageKey != pixmap.cacheKey()) {
+        // 新图片：同步提取一次，之后级别变化时在后台更新
+        shapeGeneration.advance();
+        m_pendingShapeLevel = -1;
+        m_shapeImageKey = pixmap.cacheKey();
+        m_shapeRegion = AlphaRegion::extractAtLevel(pixmap.toImage(), level);
+        qCDebug(lcMask) << "输入形状已提取，级别:" << level << "矩形数:" << m_shapeRegion.rects.size();
+    } else if (m_shapeRegion.level != level) {
+        requestShapeRegion(level);
+    } else if (m_pendingShapeLevel != -1) {
+        // 又缩放回已缓存的级别，放弃正在计算的结果
+        shapeGeneration.advance();
+        m_pendingShapeLevel = -1;
     }
 
-    QImage alphaImg = smallMask.toImage().convertToFormat(QImage::Format_Alpha8);
-    QBitmap maskBitmap(alphaImg.size());
-    maskBitmap.fill(Qt::color0);
-    {
-        QPainter mp(&maskBitmap);
-        mp.setPen(Qt::color1);
-        mp.setBrush(Qt::color1);
-        for (int y = 0; y < alphaImg.height(); ++y) {
-            for (int x = 0; x < alphaImg.width(); ++x) {
-                if (qAlpha(alphaImg.pixel(x, y)) > 30) {
-                    mp.drawPoint(x, y);
-                }
-            }
-        }
-    }
+    const QTransform shapeToWidget = m_shapeRegion.toImage(pixmap.size()) * view;
+    setX11ShapeRects(AlphaRegion::mapped(m_shapeRegion.rects, shapeToWidget, rect()),
+                     AlphaRegion::preservesBands(shapeToWidget));
+}
 
-    if (maskScale < 1.0) {
-        maskBitmap = maskBitmap.scaled(scaledPiece.size(),
-                                       Qt::KeepAspectRatio,
-                                       Qt::FastTransformation);
-    }
+// 形状采样级别：采样分辨率不低于屏幕分辨率（最多原图），长边不超过 kMaxShapeSide，
+// 取整到 2 的幂，缩放只有跨过级别边界时才需要重新提取
+int ImageWidget::shapeLevelFor(const QTransform &view) const
+{
+    const int kMaxShapeSide = 1024;
+    const double displayScale = std::hypot(view.m11(), view.m12());
+    const double sampleScale = qMin({1.0, displayScale,
+                                     double(kMaxShapeSide) / qMax(pixmap.width(), pixmap.height())});
+    if (sampleScale <= 0) return 0;
+    return qBound(0, int(std::ceil(std::log2(1.0 / sampleScale) - 1e-9)), 16);
+}
 
-    QRegion finalMask;
-    finalMask += QRegion(maskBitmap).translated(visibleRect.topLeft());
-    setX11Shape(finalMask);
+void ImageWidget::requestShapeRegion(int level)
+{
+    if (m_pendingShapeLevel == level) return;   // 同一级别已在计算
+
+    shapeGeneration.advance();
+    const CancellationToken token = shapeGeneration.token();
+    const qint64 imageKey = pixmap.cacheKey();
+    const QImage source = pixmap.toImage();
+    m_pendingShapeLevel = level;
+
+    QFuture<AlphaRegion::LevelRegion> future = QtConcurrent::run(ThreadPools::cpu(), [source, level, token]() {
+        if (token.isCancelled()) return AlphaRegion::LevelRegion();
+        return AlphaRegion::extractAtLevel(source, level);
+    });
+
+    auto *watcher = new QFutureWatcher<AlphaRegion::LevelRegion>(this);
+    connect(watcher, &QFutureWatcher<AlphaRegion::LevelRegion>::finished, this, [this, watcher, imageKey, token]() {
+        AlphaRegion::LevelRegion region = watcher->result();
+        watcher->deleteLater();
+        if (token.isCancelled() || imageKey != m_shapeImageKey) return;
+
+        m_pendingShapeLevel = -1;
+        m_shapeRegion = std::move(region);
+        qCDebug(lcMask) << "输入形状已更新，级别:" << m_shapeRegion.level << "矩形数:" << m_shapeRegion.rects.size();
+        updateMask();
+    });
+    watcher->setFuture(future);
 }
 
 
@@ -283,14 +319,14 @@ void ImageWidget::setMask(const QRegion &region)
 {
     // 🚨 缩略图模式下禁止任何 setMask 调用！
     if (currentViewMode != SingleView) {
-        qDebug() << "\n🔥 非法 setMask 调用！当前模式:"
+        qCWarning(lcMask) << "\n🔥 非法 setMask 调用！当前模式:"
                  << (currentViewMode == SingleView ? "SingleView" : "ThumbnailView")
                  << "，已拦截。堆栈如下：";
         void* callstack[128];
         int frames = backtrace(callstack, 128);
         char** strs = backtrace_symbols(callstack, frames);
         for (int i = 0; i < frames; ++i) {
-            qDebug() << "  " << strs[i];
+            qCWarning(lcMask) << "  " << strs[i];
         }
         free(strs);
         return;  // ⚡ 不调用 QWidget::setMask，直接返回！
@@ -301,73 +337,58 @@ void ImageWidget::setMask(const QRegion &region)
 
 void ImageWidget::clearMask()
 {
-    qDebug() << "【clearMask】调用，模式:"
-             << (currentViewMode == SingleView ? "SingleView" : "ThumbnailView");
     QWidget::clearMask();
 }
 
 // 清除 X11 输入形状
 void ImageWidget::clearX11Shape()
 {
+    PV_TRACE_SCOPE_CAT("clearX11Shape", "mask");
 #ifdef Q_OS_LINUX
-    if (!QGuiApplication::platformName().contains("xcb")) return;
-    Display *display = XOpenDisplay(nullptr);
+    Display *display = X11Display::get();
     if (!display) return;
     Window windowId = (Window)winId();
     if (windowId) {
+        if (m_inputShapeWindow == windowId && m_inputShapeCleared) return;
+
         // 清除输入形状，恢复全窗口可点
         XShapeCombineMask(display, windowId, ShapeInput, 0, 0, None, ShapeSet);
         XFlush(display);
-        qDebug() << "X11 形状已清除";
+        m_inputShapeWindow = windowId;
+        m_inputShapeCleared = true;
+        m_appliedInputShape.clear();
+        qCDebug(lcMask) << "X11 形状已清除";
     }
-    XCloseDisplay(display);
 #endif
 }
 
 // 设置单个矩形形状
 void ImageWidget::setX11ShapeRect(const QRect &rect)
 {
-#ifdef Q_OS_LINUX
-    if (!QGuiApplication::platformName().contains("xcb")) return;
-    Display *display = XOpenDisplay(nullptr);
-    if (!display) return;
-    Window windowId = (Window)winId();
-    if (windowId) {
-        XRectangle xr = { (short)rect.x(), (short)rect.y(),
-                         (unsigned short)rect.width(), (unsigned short)rect.height() };
-        XShapeCombineRectangles(display, windowId, ShapeInput, 0, 0, &xr, 1, ShapeSet, YXBanded);
-        XFlush(display);
-
-        // 读取当前输入形状并打印
-        int count = 0;
-        int ordering = 0;
-        XRectangle *rects = XShapeGetRectangles(display, windowId, ShapeInput, &count, &ordering);
-        qDebug() << "实际 X11 输入形状矩形数:" << count;
-        for (int i = 0; i < count; ++i) {
-            qDebug() << "  " << rects[i].x << rects[i].y << rects[i].width << rects[i].height;
-        }
-        XFree(rects);
-
-        XCloseDisplay(display);
-    }
-#endif
+    setX11Shape(QRegion(rect));
 }
 
 // 设置复杂形状（多个矩形）
 void ImageWidget::setX11Shape(const QRegion &region)
 {
+    // QRegion 本身就是按行分带排列的
+    setX11ShapeRects(QVector<QRect>(region.begin(), region.end()));
+}
+
+// 提交矩形列表；banded 为 true 时必须已按 YX 分带排列
+void ImageWidget::setX11ShapeRects(const QVector<QRect> &shape, bool banded)
+{
+    PV_TRACE_SCOPE_CAT("setX11Shape", "mask");
 #ifdef Q_OS_LINUX
-    if (!QGuiApplication::platformName().contains("xcb")) return;
-    Display *display = XOpenDisplay(nullptr);
+    Display *display = X11Display::get();
     if (!display) return;
     Window windowId = (Window)winId();
     if (windowId) {
-        // 先清除旧的形状
-        XShapeCombineMask(display, windowId, ShapeInput, 0, 0, None, ShapeSet);
+        if (m_inputShapeWindow == windowId && !m_inputShapeCleared && m_appliedInputShape == shape) return;
 
-        // 将 QRegion 转换为 XRectangle 列表
         QVector<XRectangle> rects;
-        for (const QRect &r : region) {
+        rects.reserve(shape.size());
+        for (const QRect &r : shape) {
             XRectangle xr;
             xr.x = static_cast<short>(r.x());
             xr.y = static_cast<short>(r.y());
@@ -375,11 +396,22 @@ void ImageWidget::setX11Shape(const QRegion &region)
             xr.height = static_cast<unsigned short>(r.height());
             rects.append(xr);
         }
+        // ShapeSet 直接替换旧形状，无需先清除
         XShapeCombineRectangles(display, windowId, ShapeInput,
-                                0, 0, rects.data(), rects.size(), ShapeSet, YXBanded);
+                                0, 0, rects.data(), rects.size(), ShapeSet, banded ? YXBanded : Unsorted);
         XFlush(display);
-        qDebug() << "X11 形状已更新，矩形数:" << rects.size();
+        m_inputShapeWindow = windowId;
+        m_inputShapeCleared = false;
+        m_appliedInputShape = shape;
+        qCDebug(lcMask) << "X11 形状已更新，矩形数:" << rects.size();
     }
-    XCloseDisplay(display);
 #endif
 }
+
+void ImageWidget::scheduleMaskUpdate()
+{
+    m_maskDirty = true;
+    if (!maskUpdateTimer.isActive()) {
+        maskUpdateTimer.start();
+    }
+}
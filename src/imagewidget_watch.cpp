@@ -0,0 +1,144 @@
+// imagewidget_watch.cpp
+#include "imagewidget.h"
+
+void ImageWidget::onWatchedFilesWritten(const QStringList &fileNames)
+{
+    if (isArchiveMode) return;
+
+    for (const QString &fileName : fileNames) {
+        QString filePath = currentDir.absoluteFilePath(fileName);
+        // 文件内容变了，之前的格式识别和解码失败记录都作废
+        FormatSniffer::invalidate(filePath);
+        if (!isListableFile(fileName)) continue;
+
+        imageSorter.addFile(QFileInfo(filePath));
+
+        int existingIndex = imageList.indexOf(fileName);
+        if (existingIndex >= 0) {
+            // 已有文件被覆盖：只刷新这一项的缓存和缩略图
+            {
+                QMutexLocker locker(&cacheMutex);
+                removeCachedImage(imageCache, filePath);
+            }
+            // 按时间/大小排序时修改后的位置可能变化
+            moveToSortedPosition(existingIndex);
+            thumbnailWidget->reloadImage(imageList.indexOf(fileName));
+            continue;
+        }
+
+        int insertIndex = sortedInsertPosition(fileName);
+        imageList.insert(insertIndex, fileName);
+        if (currentImageIndex >= insertIndex) {
+            ++currentImageIndex;
+        }
+        thumbnailWidget->insertImage(insertIndex, fileName);
+    }
+
+    qCDebug(lcScan) << "目录监视：新增/修改" << fileNames.size() << "个文件，当前总数:" << imageList.size();
+    updateWindowTitle();
+    requestExifSortKeys();
+}
+
+void ImageWidget::onWatchedFilesRemoved(const QStringList &fileNames)
+{
+    if (isArchiveMode) return;
+
+    for (const QString &fileName : fileNames) {
+        FormatSniffer::invalidate(currentDir.absoluteFilePath(fileName));
+        int index = imageList.indexOf(fileName);
+        if (index < 0) continue;  // 例如本程序自己删除的文件，列表已经更新过
+
+        imageList.removeAt(index);
+        imageSorter.removeFile(fileName);
+        {
+            QMutexLocker locker(&cacheMutex);
+            removeCachedImage(imageCache, currentDir.absoluteFilePath(fileName));
+        }
+        thumbnailWidget->removeImage(index);
+
+        if (currentImageIndex > index) {
+            --currentImageIndex;
+        } else if (currentImageIndex == index) {
+            // 正在显示的图片被删除：保留画面，索引指向下一张以便继续浏览
+            currentImageIndex = qMin(index, imageList.size() - 1);
+        }
+    }
+
+    updateWindowTitle();
+}
+
+void ImageWidget::onWatchedFileRenamed(const QString &oldName, const QString &newName)
+{
+    if (isArchiveMode) return;
+
+    FormatSniffer::invalidate(currentDir.absoluteFilePath(oldName));
+    FormatSniffer::invalidate(currentDir.absoluteFilePath(newName));
+
+    int oldIndex = imageList.indexOf(oldName);
+    bool newListable = isListableFile(newName);
+
+    if (oldIndex < 0) {
+        if (newListable) onWatchedFilesWritten(QStringList{newName});
+        return;
+    }
+    if (!newListable) {
+        onWatchedFilesRemoved(QStringList{oldName});
+        return;
+    }
+
+    // 重命名覆盖了列表中另一个文件
+    if (imageList.contains(newName)) {
+        onWatchedFilesRemoved(QStringList{newName});
+        oldIndex = imageList.indexOf(oldName);
+    }
+
+    imageSorter.removeFile(oldName);
+    imageSorter.addFile(QFileInfo(currentDir.absoluteFilePath(newName)));
+
+    bool wasCurrent = (currentImageIndex == oldIndex);
+    imageList.removeAt(oldIndex);
+    if (currentImageIndex > oldIndex) {
+        --currentImageIndex;
+    }
+
+    int newIndex = sortedInsertPosition(newName);
+    imageList.insert(newIndex, newName);
+    if (wasCurrent) {
+        currentImageIndex = newIndex;
+    } else if (currentImageIndex >= newIndex) {
+        ++currentImageIndex;
+    }
+
+    // 缩略图和图片缓存直接迁移，不重新解码
+    thumbnailWidget->renameImage(oldIndex, newIndex, newName);
+
+    QString oldPath = currentDir.absoluteFilePath(oldName);
+    QString newPath = currentDir.absoluteFilePath(newName);
+    {
+        QMutexLocker locker(&cacheMutex);
+        if (imageCache.contains(oldPath)) {
+            imageCache.insert(newPath, imageCache.take(oldPath));
+        }
+    }
+    if (currentImagePath == oldPath) {
+        currentImagePath = newPath;
+    }
+
+    updateWindowTitle();
+    requestExifSortKeys();
+}
+
+void ImageWidget::onWatchedFolderRescan()
+{
+    if (isArchiveMode) return;
+
+    qCDebug(lcScan) << "目录监视事件溢出，重新扫描:" << currentDir.absolutePath();
+
+    QString currentFileName = imageList.value(currentImageIndex);
+    loadImageList();
+    currentImageIndex = currentFileName.isEmpty() ? -1 : imageList.indexOf(currentFileName);
+    if (currentViewMode == ThumbnailView) {
+        thumbnailWidget->setSelectedIndex(currentImageIndex);
+    }
+    updateWindowTitle();
+}
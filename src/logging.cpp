@@ -0,0 +1,10 @@
+// logging.cpp
+#include "logging.h"
+
+// 只记录 info 及以上，调试输出按需通过 QT_LOGGING_RULES 打开
+Q_LOGGING_CATEGORY(lcArchive, "pv.archive", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcDecode, "pv.decode", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcThumbnail, "pv.thumbnail", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcMask, "pv.mask", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcScan, "pv.scan", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcApp, "pv.app", QtInfoMsg)
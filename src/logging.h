@@ -0,0 +1,18 @@
+// logging.h
+#ifndef LOGGING_H
+#define LOGGING_H
+
+#include <QLoggingCategory>
+
+// 分类日志。热路径（解码、压缩包、缩略图、掩码）的调试输出默认关闭，需要时用
+//   QT_LOGGING_RULES="pv.archive.debug=true"
+// 打开。Release 构建定义了 QT_NO_DEBUG_OUTPUT，qCDebug 在编译期被整个去掉，
+// 参数不会求值，也不会格式化字符串。
+Q_DECLARE_LOGGING_CATEGORY(lcArchive)     // pv.archive   压缩包读取
+Q_DECLARE_LOGGING_CATEGORY(lcDecode)      // pv.decode    解码/缩放
+Q_DECLARE_LOGGING_CATEGORY(lcThumbnail)   // pv.thumbnail 缩略图加载与缓存
+Q_DECLARE_LOGGING_CATEGORY(lcMask)        // pv.mask      窗口掩码/X11 形状
+Q_DECLARE_LOGGING_CATEGORY(lcScan)        // pv.scan      目录扫描/排序/监视
+Q_DECLARE_LOGGING_CATEGORY(lcApp)         // pv.app       启动/单实例/多窗口
+
+#endif // LOGGING_H
@@ -1,4 +1,10 @@
 #include "imagewidget.h"
+#include "threadpools.h"
+#include "thumbnailbatch.h"
+#include "trace.h"
+#include "metricsserver.h"
+#include "singleinstance.h"
+#include "startuptimer.h"
 #include "qimagereader.h"
 #include <QApplication>
 #include <QCommandLineParser>
@@ -6,6 +12,8 @@
 #include <QTranslator>
 #include <QLibraryInfo>
 #include <QDir>
+#include <QFileInfo>
+#include <QtConcurrent>
 #include <QDebug>  // 添加QDebug头文件
 #include <QGuiApplication>  // 添加QGuiApplication头文件用于平台检测
 
@@ -18,8 +26,28 @@ int main(int argc, char *argv[])
         qDebug() << "  argv[" << i << "]:" << argv[i];
     }
 
+    // --trace out.json：尽早启用，启动过程也记录在内
+    const QString traceFile = Trace::enableFromArguments(argc, argv);
+    // --measure-startup：启动各阶段耗时，第一帧绘制后输出
+    StartupTimer::enableFromArguments(argc, argv);
+
+    // 无窗口批量生成缩略图：只需要 QCoreApplication，不连接显示服务器
+    if (ThumbnailBatch::isRequested(argc, argv)) {
+        QCoreApplication app(argc, argv);
+        // 与界面模式相同的名称，保证缓存目录一致
+        app.setApplicationName("PictureView");
+        app.setOrganizationName("berylok");
+        QImageReader::setAllocationLimit(512);
+
+        int result = ThumbnailBatch::run(app.arguments());
+        ThreadPools::shutdown();
+        if (!traceFile.isEmpty()) Trace::writeChromeJson(traceFile);
+        return result;
+    }
+
     // 创建QApplication
     QApplication app(argc, argv);
+    StartupTimer::mark("application");
 
     // 设置更高的内存分配限制（512MB）
     QImageReader::setAllocationLimit(512);
@@ -39,7 +67,74 @@ int main(int argc, char *argv[])
     qDebug() << "DISPLAY环境变量:" << qgetenv("DISPLAY");
     qDebug() << "==================";
 
-    // ... 以下是你原有的代码，保持不变 ...
+    // 命令行参数只解析一次
+    QCommandLineParser parser;
+    QCommandLineOption langOption("lang", "Override system language (e.g., zh_CN, ru_RU)", "language");
+    parser.addOption(langOption);
+    // 已在启动时由 Trace::enableFromArguments 处理，这里只登记，避免被当作未知选项
+    QCommandLineOption traceOption("trace", "Write a Chrome trace (JSON) to this file on exit", "file");
+    parser.addOption(traceOption);
+    QCommandLineOption metricsSocketOption("metrics-socket", "Serve live performance counters as JSON on this local socket", "path");
+    parser.addOption(metricsSocketOption);
+    // 注册文件关联选项
+    QCommandLineOption registerOption(
+        "register",
+        ("main", "Register file associations"));
+    parser.addOption(registerOption);
+    QCommandLineOption newInstanceOption("new-instance", "Start a separate process instead of opening a window in the running one");
+    parser.addOption(newInstanceOption);
+    // 已在启动时由 StartupTimer::enableFromArguments 处理
+    QCommandLineOption measureStartupOption("measure-startup", "Report startup milestones after the first frame is painted");
+    parser.addOption(measureStartupOption);
+    parser.addPositionalArgument("path", "Image file or folder to open");
+    parser.process(app);
+    StartupTimer::mark("arguments");
+
+    // 单实例：已有进程在运行时只把路径交给它，由它在进程内开新窗口，本进程立即退出。
+    // 跟踪/指标/注册/启动计时都针对本进程，这些情况下不转发。
+    const bool singleInstance = !parser.isSet(newInstanceOption) && !parser.isSet(registerOption)
+                                && traceFile.isEmpty() && !parser.isSet(metricsSocketOption)
+                                && !parser.isSet(measureStartupOption);
+    // 在做任何其他工作之前占住服务名，同时启动的其他进程随后都会转发到这里
+    SingleInstance instanceServer;
+    if (singleInstance) {
+        QStringList paths;
+        for (const QString &path : parser.positionalArguments()) {
+            paths << QFileInfo(path).absoluteFilePath();
+        }
+        if (instanceServer.start(paths) == SingleInstance::Forwarded) {
+            qDebug() << "已交给运行中的实例:" << paths;
+            return 0;
+        }
+    }
+
+    // 注册文件关联不需要界面，也不需要翻译
+    if (parser.isSet(registerOption)) {
+        QString exePath = QCoreApplication::applicationFilePath();
+        QString shortExePath = ImageWidget::getShortPathName(exePath);
+        QString openCommand = QString("\"%1\" \"%2\"").arg(shortExePath).arg("%1");
+
+        ImageWidget::registerFileAssociation("png", "pngfile", openCommand);
+        ImageWidget::registerFileAssociation("jpg", "jpgfile", openCommand);
+        ImageWidget::registerFileAssociation("bmp", "bmpfile", openCommand);
+        ImageWidget::registerFileAssociation("jpeg", "jpegfile", openCommand);
+        ImageWidget::registerFileAssociation("webp", "webpfile", openCommand);
+        ImageWidget::registerFileAssociation("gif", "giffile", openCommand);
+        ImageWidget::registerFileAssociation("tiff", "tifffile", openCommand);
+        ImageWidget::registerFileAssociation("tif", "tiffile", openCommand);
+
+        qDebug() << ("main", "File associations registered");
+        return 0;
+    }
+
+    // 命令行指定的图片在后台解码，与翻译加载、窗口构造并行（目录和压缩包仍走原来的路径）
+    const QString startupPath = parser.positionalArguments().value(0);
+    const bool decodeInParallel = !startupPath.isEmpty() && QFileInfo(startupPath).isFile()
+                                  && !ArchiveHandler::isSupportedArchive(startupPath);
+    QFuture<ImageWidget::DecodedImage> firstImage;
+    if (decodeInParallel) {
+        firstImage = QtConcurrent::run(ThreadPools::cpu(), &ImageWidget::decodeImageFile, startupPath);
+    }
 
 
     // 设置默认语言
@@ -93,10 +188,6 @@ int main(int argc, char *argv[])
 
 
     // 命令行参数覆盖
-    QCommandLineParser parser;
-    QCommandLineOption langOption("lang", "Override system language (e.g., zh_CN, ru_RU)", "language");
-    parser.addOption(langOption);
-    parser.process(app);
     if (parser.isSet(langOption)) {
         locale = parser.value(langOption);
     }
@@ -107,16 +198,8 @@ int main(int argc, char *argv[])
     QTranslator appTranslator;
     QTranslator qtTranslator;
 
-    // 1. 加载 Qt 自带翻译（如文件对话框的按钮）
-    QString qtTranslationsPath = QLibraryInfo::path(QLibraryInfo::TranslationsPath);
-    if (qtTranslator.load("qt_" + locale, qtTranslationsPath)) {
-        app.installTranslator(&qtTranslator);
-        qDebug() << "✅ Loaded Qt translation for" << locale;
-    } else {
-        qDebug() << "⚠️ Failed to load Qt translation for" << locale;
-    }
-
-    // 2. 加载应用程序翻译（支持多路径搜索）
+    // 1. 加载应用程序翻译（支持多路径搜索）：窗口构造时就要用到。
+    //    按顺序直接尝试加载，第一个成功的即为结果，不再先探测目录
     QStringList searchPaths;
     searchPaths << QApplication::applicationDirPath() + "/translations"                 // 开发环境
                 << QApplication::applicationDirPath() + "/../share/PictureView/translations" // AppImage 内部
@@ -124,66 +207,46 @@ int main(int argc, char *argv[])
 
     QString appTranslationsPath;
     for (const QString &path : searchPaths) {
-        if (QDir(path).exists()) {
+        if (appTranslator.load("PictureView_" + locale, path)) {
             appTranslationsPath = path;
             break;
         }
     }
-    qDebug() << "Using translation path:" << appTranslationsPath;
 
-    if (appTranslator.load("PictureView_" + locale, appTranslationsPath)) {
+    if (!appTranslationsPath.isEmpty()) {
         app.installTranslator(&appTranslator);
-        qDebug() << "✅ Loaded application translation for" << locale;
+        qDebug() << "✅ Loaded application translation for" << locale << "from" << appTranslationsPath;
     } else {
         qDebug() << "❌ Failed to load application translation for" << locale
-                 << "from" << appTranslationsPath;
-    }
-
-
-    // 注册文件关联选项
-    QCommandLineOption registerOption(
-        "register",
-        ("main", "Register file associations"));
-    parser.addOption(registerOption);
-
-    parser.process(app);
-
-    if (parser.isSet(registerOption)) {
-        QString exePath = QCoreApplication::applicationFilePath();
-        QString shortExePath = ImageWidget().getShortPathName(exePath);
-        QString openCommand = QString("\"%1\" \"%2\"").arg(shortExePath).arg("%1");
-
-        ImageWidget().registerFileAssociation("png", "pngfile", openCommand);
-        ImageWidget().registerFileAssociation("jpg", "jpgfile", openCommand);
-        ImageWidget().registerFileAssociation("bmp", "bmpfile", openCommand);
-        ImageWidget().registerFileAssociation("jpeg", "jpegfile", openCommand);
-        ImageWidget().registerFileAssociation("webp", "webpfile", openCommand);
-        ImageWidget().registerFileAssociation("gif", "giffile", openCommand);
-        ImageWidget().registerFileAssociation("tiff", "tifffile", openCommand);
-        ImageWidget().registerFileAssociation("tif", "tiffile", openCommand);
-
-        qDebug() << ("main", "File associations registered");
-        return 0;
+                 << "from" << searchPaths;
     }
+    StartupTimer::mark("translations");
 
-    ImageWidget window;
-
-    // 加载配置（必须在处理命令行参数之前）
-    window.loadConfiguration();
+    ImageWidget window;   // 构造时已加载配置
+    StartupTimer::mark("widget");
 
-    if (argc > 1) {
-        QString filePath = QString::fromLocal8Bit(argv[1]);
-        qDebug() << ("main", "Opening file:") << filePath;
-
-        if (QFile::exists(filePath)) {
-            QFileInfo fileInfo(filePath);
-            if (fileInfo.isDir()) {
-                window.setCurrentDir(QDir(filePath));
-                window.loadImageList();
-            } else {
-                window.loadImage(filePath);
-                window.switchToSingleView();
-            }
+    // 2. Qt 自带翻译只用于标准对话框（如文件对话框的按钮），第一帧之后再加载
+    window.runAfterFirstPaint([&app, &qtTranslator, locale]() {
+        QString qtTranslationsPath = QLibraryInfo::path(QLibraryInfo::TranslationsPath);
+        if (qtTranslator.load("qt_" + locale, qtTranslationsPath)) {
+            app.installTranslator(&qtTranslator);
+            qDebug() << "✅ Loaded Qt translation for" << locale;
+        } else {
+            qDebug() << "⚠️ Failed to load Qt translation for" << locale;
+        }
+    });
+
+    if (!startupPath.isEmpty()) {
+        qDebug() << ("main", "Opening file:") << startupPath;
+
+        if (decodeInParallel) {
+            // 通常此时已解码完成；否则在这里等待剩下的部分
+            ImageWidget::DecodedImage decoded = firstImage.result();
+            StartupTimer::mark("firstImageDecoded");
+            window.loadDecodedImage(std::move(decoded));
+            window.switchToSingleView();
+        } else if (QFile::exists(startupPath)) {
+            window.openPath(startupPath);
         } else {
             // 无命令行参数：根据保存的视图模式恢复
             if (window.getLastViewMode() == 1) {  // 1 表示 SingleView
@@ -195,6 +258,25 @@ int main(int argc, char *argv[])
     }
 
     window.show();
+    StartupTimer::mark("shown");
+
+    // 之后的启动把路径发到这里，在本进程内打开新窗口
+    if (singleInstance) {
+        QObject::connect(&instanceServer, &SingleInstance::openRequested, [](const QString &path) {
+            ImageWidget::openWindow(path);
+        });
+    }
+
+    // --metrics-socket <路径>：每个连接返回一行 JSON 格式的性能计数器
+    MetricsServer metricsServer;
+    const QString metricsSocket = parser.value(metricsSocketOption);
+    if (!metricsSocket.isEmpty()) {
+        metricsServer.listen(metricsSocket);
+    }
 
-    return app.exec();
+    int result = app.exec();
+    // 等后台任务退出后再析构窗口和缓存
+    ThreadPools::shutdown();
+    if (!traceFile.isEmpty()) Trace::writeChromeJson(traceFile);
+    return result;
 }
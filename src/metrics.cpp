@@ -0,0 +1,204 @@
+// metrics.cpp
+#include "metrics.h"
+#include "trace.h"
+#include <QJsonArray>
+#include <cmath>
+
+namespace Metrics
+{
+namespace
+{
+
+// 提取耗时分桶：第 i 桶为 [2^i, 2^(i+1)) 微秒，最后一桶收容更慢的
+constexpr int kLatencyBuckets = 24;
+
+struct Counters {
+    std::atomic<qint64> lastFrameNs{0};
+    std::atomic<qint64> averageFrameNs{0};
+    std::atomic<qint64> frames{0};
+
+    std::atomic<int> decodeQueueDepth{0};
+    std::atomic<qint64> thumbnailsDecoded{0};
+    std::atomic<qint64> thumbnailsFailed{0};
+
+    std::atomic<qint64> hits[TierCount] = {};
+    std::atomic<qint64> misses[TierCount] = {};
+    std::atomic<qint64> bytes[TierCount] = {};
+
+    std::atomic<qint64> extractions{0};
+    std::atomic<qint64> latencyBuckets[kLatencyBuckets] = {};
+};
+
+Counters &counters()
+{
+    static Counters instance;
+    return instance;
+}
+
+int bucketFor(qint64 durationNs)
+{
+    qint64 us = qMax<qint64>(1, durationNs / 1000);
+    int bucket = 0;
+    while (us > 1 && bucket < kLatencyBuckets - 1) {
+        us >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+// 分位数取所在桶的上界（保守估计）
+double percentileMs(const qint64 (&buckets)[kLatencyBuckets], qint64 total, double fraction)
+{
+    if (total <= 0) return 0;
+    const qint64 target = qint64(std::ceil(total * fraction));
+    qint64 seen = 0;
+    for (int i = 0; i < kLatencyBuckets; ++i) {
+        seen += buckets[i];
+        if (seen >= target) {
+            return double(qint64(1) << (i + 1)) / 1000.0;
+        }
+    }
+    return double(qint64(1) << kLatencyBuckets) / 1000.0;
+}
+
+} // namespace
+
+void recordFrame(qint64 durationNs)
+{
+    Counters &c = counters();
+    c.lastFrameNs.store(durationNs, std::memory_order_relaxed);
+    // 只有 GUI 线程绘制，读-改-写无需 CAS
+    const qint64 average = c.averageFrameNs.load(std::memory_order_relaxed);
+    c.averageFrameNs.store(average == 0 ? durationNs : average + (durationNs - average) / 8,
+                           std::memory_order_relaxed);
+    c.frames.fetch_add(1, std::memory_order_relaxed);
+}
+
+void addQueuedDecodes(int count)
+{
+    counters().decodeQueueDepth.fetch_add(count, std::memory_order_relaxed);
+}
+
+void decodeFinished(bool success)
+{
+    Counters &c = counters();
+    c.decodeQueueDepth.fetch_sub(1, std::memory_order_relaxed);
+    (success ? c.thumbnailsDecoded : c.thumbnailsFailed).fetch_add(1, std::memory_order_relaxed);
+}
+
+void cacheHit(CacheTier tier)
+{
+    counters().hits[tier].fetch_add(1, std::memory_order_relaxed);
+}
+
+void cacheMiss(CacheTier tier)
+{
+    counters().misses[tier].fetch_add(1, std::memory_order_relaxed);
+}
+
+void setCacheBytes(CacheTier tier, qint64 bytes)
+{
+    counters().bytes[tier].store(bytes, std::memory_order_relaxed);
+}
+
+void addCacheBytes(CacheTier tier, qint64 bytes)
+{
+    counters().bytes[tier].fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void recordExtraction(qint64 durationNs)
+{
+    Counters &c = counters();
+    c.latencyBuckets[bucketFor(durationNs)].fetch_add(1, std::memory_order_relaxed);
+    c.extractions.fetch_add(1, std::memory_order_relaxed);
+}
+
+Snapshot snapshot()
+{
+    Counters &c = counters();
+    Snapshot s;
+    s.lastFrameMs = c.lastFrameNs.load(std::memory_order_relaxed) / 1e6;
+    s.averageFrameMs = c.averageFrameNs.load(std::memory_order_relaxed) / 1e6;
+    s.frames = c.frames.load(std::memory_order_relaxed);
+    s.decodeQueueDepth = qMax(0, c.decodeQueueDepth.load(std::memory_order_relaxed));
+    s.thumbnailsDecoded = c.thumbnailsDecoded.load(std::memory_order_relaxed);
+    s.thumbnailsFailed = c.thumbnailsFailed.load(std::memory_order_relaxed);
+    for (int i = 0; i < TierCount; ++i) {
+        s.hits[i] = c.hits[i].load(std::memory_order_relaxed);
+        s.misses[i] = c.misses[i].load(std::memory_order_relaxed);
+        s.bytes[i] = c.bytes[i].load(std::memory_order_relaxed);
+    }
+
+    qint64 buckets[kLatencyBuckets];
+    qint64 total = 0;
+    for (int i = 0; i < kLatencyBuckets; ++i) {
+        buckets[i] = c.latencyBuckets[i].load(std::memory_order_relaxed);
+        total += buckets[i];
+    }
+    s.extractions = total;
+    s.extractP50Ms = percentileMs(buckets, total, 0.50);
+    s.extractP90Ms = percentileMs(buckets, total, 0.90);
+    s.extractP99Ms = percentileMs(buckets, total, 0.99);
+    return s;
+}
+
+const char *tierName(CacheTier tier)
+{
+    switch (tier) {
+    case MemoryTier: return "memory";
+    case DiskTier: return "disk";
+    case ImageTier: return "image";
+    default: return "unknown";
+    }
+}
+
+QJsonObject toJson(const Snapshot &s, double thumbnailsPerSecond)
+{
+    QJsonObject caches;
+    for (int i = 0; i < TierCount; ++i) {
+        const qint64 lookups = s.hits[i] + s.misses[i];
+        caches.insert(tierName(CacheTier(i)), QJsonObject{
+            {"hits", s.hits[i]},
+            {"misses", s.misses[i]},
+            {"hitRate", lookups > 0 ? double(s.hits[i]) / lookups : 0.0},
+            {"bytes", s.bytes[i]},
+        });
+    }
+
+    return QJsonObject{
+        {"frame", QJsonObject{{"lastMs", s.lastFrameMs}, {"averageMs", s.averageFrameMs}, {"count", s.frames}}},
+        {"decodeQueueDepth", s.decodeQueueDepth},
+        {"thumbnails", QJsonObject{{"decoded", s.thumbnailsDecoded},
+                                   {"failed", s.thumbnailsFailed},
+                                   {"perSecond", thumbnailsPerSecond}}},
+        {"caches", caches},
+        {"archiveExtraction", QJsonObject{{"count", s.extractions},
+                                          {"p50Ms", s.extractP50Ms},
+                                          {"p90Ms", s.extractP90Ms},
+                                          {"p99Ms", s.extractP99Ms}}},
+    };
+}
+
+double RateSampler::sample(const Snapshot &s)
+{
+    const qint64 nowNs = Trace::now();
+    const qint64 count = s.thumbnailsDecoded + s.thumbnailsFailed;
+    double rate = 0;
+    if (m_lastCount >= 0 && nowNs > m_lastTimeNs) {
+        rate = double(count - m_lastCount) * 1e9 / double(nowNs - m_lastTimeNs);
+    }
+    m_lastCount = count;
+    m_lastTimeNs = nowNs;
+    return rate;
+}
+
+FrameScope::FrameScope() : m_start(Trace::now())
+{
+}
+
+FrameScope::~FrameScope()
+{
+    recordFrame(Trace::now() - m_start);
+}
+
+} // namespace Metrics
@@ -0,0 +1,82 @@
+// metrics.h
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <QJsonObject>
+#include <QtGlobal>
+#include <atomic>
+
+// 运行时性能计数器：全部在事件发生处增量更新（原子操作，任意线程可写），
+// 读取时只取快照，不遍历图片列表或缓存。性能浮层和指标套接字共用这些数据。
+namespace Metrics
+{
+    enum CacheTier {
+        MemoryTier = 0,    // 缩略图内存缓存（QPixmap）
+        DiskTier,          // 缩略图磁盘缓存
+        ImageTier,         // 原图缓存（预加载/浏览）
+        TierCount
+    };
+
+    // 一帧的绘制耗时
+    void recordFrame(qint64 durationNs);
+
+    // 缩略图任务：提交时 +n，结果取出时 -1
+    void addQueuedDecodes(int count);
+    void decodeFinished(bool success);
+
+    void cacheHit(CacheTier tier);
+    void cacheMiss(CacheTier tier);
+    // 缓存当前占用（内存层为 QCache::totalCost，磁盘层为本次运行写入的字节数）
+    void setCacheBytes(CacheTier tier, qint64 bytes);
+    void addCacheBytes(CacheTier tier, qint64 bytes);
+
+    // 压缩包条目提取耗时，按 2 的幂分桶，用于估算分位数
+    void recordExtraction(qint64 durationNs);
+
+    struct Snapshot {
+        double lastFrameMs = 0;
+        double averageFrameMs = 0;       // 指数滑动平均
+        qint64 frames = 0;
+        int decodeQueueDepth = 0;
+        qint64 thumbnailsDecoded = 0;
+        qint64 thumbnailsFailed = 0;
+        qint64 hits[TierCount] = {};
+        qint64 misses[TierCount] = {};
+        qint64 bytes[TierCount] = {};
+        qint64 extractions = 0;
+        double extractP50Ms = 0;
+        double extractP90Ms = 0;
+        double extractP99Ms = 0;
+    };
+    Snapshot snapshot();
+
+    // thumbnailsPerSecond 由调用方根据两次快照计算后传入
+    QJsonObject toJson(const Snapshot &snapshot, double thumbnailsPerSecond);
+    const char *tierName(CacheTier tier);
+
+    // 缩略图吞吐：每个读取方各持有一个，按两次采样之间的增量计算每秒解码数
+    class RateSampler
+    {
+    public:
+        double sample(const Snapshot &snapshot);
+
+    private:
+        qint64 m_lastCount = -1;
+        qint64 m_lastTimeNs = 0;
+    };
+
+    // 帧计时：构造时开始，析构时记录
+    class FrameScope
+    {
+    public:
+        FrameScope();
+        ~FrameScope();
+        FrameScope(const FrameScope &) = delete;
+        FrameScope &operator=(const FrameScope &) = delete;
+
+    private:
+        qint64 m_start;
+    };
+}
+
+#endif // METRICS_H
@@ -0,0 +1,52 @@
+// metricsserver.cpp
+#include "metricsserver.h"
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QJsonDocument>
+#include <QDebug>
+
+MetricsServer::MetricsServer(QObject *parent)
+    : QObject(parent),
+    m_server(new QLocalServer(this))
+{
+    // 只允许当前用户连接
+    m_server->setSocketOptions(QLocalServer::UserAccessOption);
+    connect(m_server, &QLocalServer::newConnection, this, &MetricsServer::handleNewConnection);
+}
+
+MetricsServer::~MetricsServer()
+{
+    close();
+}
+
+bool MetricsServer::listen(const QString &socketPath)
+{
+    close();
+    QLocalServer::removeServer(socketPath);
+    if (!m_server->listen(socketPath)) {
+        qWarning() << "无法监听指标套接字:" << socketPath << m_server->errorString();
+        return false;
+    }
+    qInfo() << "指标套接字:" << m_server->fullServerName();
+    return true;
+}
+
+void MetricsServer::close()
+{
+    if (m_server->isListening()) {
+        m_server->close();
+    }
+}
+
+void MetricsServer::handleNewConnection()
+{
+    while (QLocalSocket *socket = m_server->nextPendingConnection()) {
+        const Metrics::Snapshot snapshot = Metrics::snapshot();
+        QByteArray line = QJsonDocument(Metrics::toJson(snapshot, m_rate.sample(snapshot)))
+                              .toJson(QJsonDocument::Compact);
+        line += '\n';
+        connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+        socket->write(line);
+        socket->disconnectFromServer();   // 缓冲区写完后才真正断开
+    }
+}
@@ -0,0 +1,34 @@
+// metricsserver.h
+#ifndef METRICSSERVER_H
+#define METRICSSERVER_H
+
+#include "metrics.h"
+#include <QObject>
+#include <QString>
+
+class QLocalServer;
+
+// 本地套接字导出性能计数器：每个连接收到一行紧凑 JSON 后即被关闭，
+// 便于脚本采样，例如 `socat - UNIX-CONNECT:/tmp/pictureview.sock`。
+// 数据与性能浮层相同，来自 Metrics::snapshot()，不扫描任何列表。
+class MetricsServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MetricsServer(QObject *parent = nullptr);
+    ~MetricsServer();
+
+    // 监听指定路径（已存在的残留套接字会先移除）
+    bool listen(const QString &socketPath);
+    void close();
+
+private slots:
+    void handleNewConnection();
+
+private:
+    QLocalServer *m_server;
+    Metrics::RateSampler m_rate;
+};
+
+#endif // METRICSSERVER_H
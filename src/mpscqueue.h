@@ -0,0 +1,69 @@
+// mpscqueue.h
+#ifndef MPSCQUEUE_H
+#define MPSCQUEUE_H
+
+#include <atomic>
+#include <utility>
+
+// 多生产者单消费者无锁队列（Vyukov 链表队列）。
+// push() 可以在任意线程调用，不加锁、不等待；tryPop() 只能在唯一的消费者线程（GUI 线程）调用。
+// 生产者刚交换完 head 还没来得及链接 next 时，消费者会暂时看到队列为空，
+// 下一次取的时候就能拿到，不影响按帧批量取出的用法。
+template <typename T>
+class MpscQueue
+{
+public:
+    MpscQueue()
+        : m_head(new Node),
+        m_tail(m_head.load(std::memory_order_relaxed))
+    {
+    }
+
+    ~MpscQueue()
+    {
+        T discarded;
+        while (tryPop(discarded)) {
+        }
+        delete m_tail;
+    }
+
+    MpscQueue(const MpscQueue &) = delete;
+    MpscQueue &operator=(const MpscQueue &) = delete;
+
+    void push(T value)
+    {
+        Node *node = new Node;
+        node->value = std::move(value);
+        Node *prev = m_head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    bool tryPop(T &out)
+    {
+        Node *tail = m_tail;
+        Node *next = tail->next.load(std::memory_order_acquire);
+        if (!next) return false;
+
+        out = std::move(next->value);
+        m_tail = next;
+        delete tail;
+        return true;
+    }
+
+    // 只在消费者线程调用，结果仅供参考
+    bool isEmpty() const
+    {
+        return m_tail->next.load(std::memory_order_acquire) == nullptr;
+    }
+
+private:
+    struct Node {
+        std::atomic<Node *> next{nullptr};
+        T value{};
+    };
+
+    std::atomic<Node *> m_head;   // 生产者端
+    Node *m_tail;                 // 消费者端
+};
+
+#endif // MPSCQUEUE_H
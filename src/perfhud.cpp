@@ -0,0 +1,113 @@
+// perfhud.cpp
+#include "perfhud.h"
+#include <QPainter>
+#include <QFontDatabase>
+#include <QFontMetrics>
+
+static const int kRefreshIntervalMs = 500;
+static const int kMargin = 8;
+static const int kPadding = 6;
+
+static QString formatBytes(qint64 bytes)
+{
+    if (bytes >= (qint64(1) << 30)) return QString("%1 GB").arg(bytes / double(1 << 30), 0, 'f', 2);
+    if (bytes >= (1 << 20)) return QString("%1 MB").arg(bytes / double(1 << 20), 0, 'f', 1);
+    if (bytes >= (1 << 10)) return QString("%1 KB").arg(bytes / double(1 << 10), 0, 'f', 1);
+    return QString("%1 B").arg(bytes);
+}
+
+PerfHud::PerfHud(QWidget *parent)
+    : QWidget(parent)
+{
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    setAttribute(Qt::WA_NoSystemBackground);
+    setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+
+    m_refreshTimer.setInterval(kRefreshIntervalMs);
+    connect(&m_refreshTimer, &QTimer::timeout, this, &PerfHud::refresh);
+    hide();
+}
+
+void PerfHud::toggle()
+{
+    setVisible(!isVisible());
+}
+
+void PerfHud::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    m_rate = Metrics::RateSampler();
+    refresh();
+    m_refreshTimer.start();
+}
+
+void PerfHud::hideEvent(QHideEvent *event)
+{
+    m_refreshTimer.stop();
+    QWidget::hideEvent(event);
+}
+
+void PerfHud::refresh()
+{
+    const Metrics::Snapshot s = Metrics::snapshot();
+    const double thumbnailsPerSecond = m_rate.sample(s);
+
+    m_lines.clear();
+    m_lines << QString("frame   %1 ms  (avg %2 ms, %3 fps)")
+                   .arg(s.lastFrameMs, 0, 'f', 2)
+                   .arg(s.averageFrameMs, 0, 'f', 2)
+                   .arg(s.averageFrameMs > 0 ? 1000.0 / s.averageFrameMs : 0.0, 0, 'f', 0);
+    m_lines << QString("decode  queue %1  |  %2 thumbs/s  (%3 ok, %4 failed)")
+                   .arg(s.decodeQueueDepth)
+                   .arg(thumbnailsPerSecond, 0, 'f', 1)
+                   .arg(s.thumbnailsDecoded)
+                   .arg(s.thumbnailsFailed);
+    for (int i = 0; i < Metrics::TierCount; ++i) {
+        const qint64 lookups = s.hits[i] + s.misses[i];
+        m_lines << QString("%1 %2% hit  (%3/%4)  %5")
+                       .arg(QString(Metrics::tierName(Metrics::CacheTier(i))), -7)
+                       .arg(lookups > 0 ? 100.0 * s.hits[i] / lookups : 0.0, 5, 'f', 1)
+                       .arg(s.hits[i])
+                       .arg(lookups)
+                       .arg(formatBytes(s.bytes[i]));
+    }
+    m_lines << QString("extract p50 %1 ms  p90 %2 ms  p99 %3 ms  (n=%4)")
+                   .arg(s.extractP50Ms, 0, 'f', 2)
+                   .arg(s.extractP90Ms, 0, 'f', 2)
+                   .arg(s.extractP99Ms, 0, 'f', 2)
+                   .arg(s.extractions);
+
+    placeInParent();
+    update();
+}
+
+void PerfHud::placeInParent()
+{
+    const QFontMetrics metrics(font());
+    int textWidth = 0;
+    for (const QString &line : m_lines) {
+        textWidth = qMax(textWidth, metrics.horizontalAdvance(line));
+    }
+    const QSize size(textWidth + 2 * kPadding, metrics.lineSpacing() * m_lines.size() + 2 * kPadding);
+    const int x = parentWidget() ? parentWidget()->width() - size.width() - kMargin : kMargin;
+    setGeometry(QRect(QPoint(qMax(kMargin, x), kMargin), size));
+    raise();
+}
+
+void PerfHud::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+
+    QPainter painter(this);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(QColor(0, 0, 0, 170));
+    painter.drawRoundedRect(rect(), 4, 4);
+
+    const QFontMetrics metrics(font());
+    painter.setPen(QColor(120, 255, 120));
+    int y = kPadding + metrics.ascent();
+    for (const QString &line : m_lines) {
+        painter.drawText(kPadding, y, line);
+        y += metrics.lineSpacing();
+    }
+}
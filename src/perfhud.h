@@ -0,0 +1,37 @@
+// perfhud.h
+#ifndef PERFHUD_H
+#define PERFHUD_H
+
+#include "metrics.h"
+#include <QWidget>
+#include <QTimer>
+#include <QStringList>
+
+// 性能浮层（F12 切换）：显示帧耗时、解码队列深度、缩略图吞吐、各级缓存命中率和占用、
+// 压缩包提取耗时分位数。只在可见时每 500ms 取一次 Metrics 快照，隐藏时没有任何开销。
+class PerfHud : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit PerfHud(QWidget *parent = nullptr);
+
+    void toggle();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private slots:
+    void refresh();
+
+private:
+    void placeInParent();
+
+    QTimer m_refreshTimer;
+    Metrics::RateSampler m_rate;
+    QStringList m_lines;
+};
+
+#endif // PERFHUD_H
@@ -0,0 +1,162 @@
+// singleinstance.cpp
+#include "singleinstance.h"
+#include "logging.h"
+#include "trace.h"
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStandardPaths>
+#include <QLockFile>
+#include <QDir>
+#include <QDebug>
+
+namespace
+{
+// 一条请求的上限：远超正常路径列表，只为防止异常连接无限占用内存
+constexpr qint64 kMaxRequestBytes = 1 << 20;
+}
+
+SingleInstance::SingleInstance(QObject *parent)
+    : QObject(parent),
+    m_server(new QLocalServer(this))
+{
+    // 只允许当前用户连接
+    m_server->setSocketOptions(QLocalServer::UserAccessOption);
+    connect(m_server, &QLocalServer::newConnection, this, &SingleInstance::handleNewConnection);
+}
+
+SingleInstance::~SingleInstance()
+{
+    if (m_server->isListening()) {
+        m_server->close();
+    }
+}
+
+QString SingleInstance::serverName()
+{
+#ifdef Q_OS_WIN
+    // 命名管道按会话隔离，加上用户名避免同机多用户冲突
+    return QString("PictureView-%1").arg(qEnvironmentVariable("USERNAME"));
+#else
+    const QString runtimeDir = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+    if (!runtimeDir.isEmpty()) {
+        return runtimeDir + "/PictureView.sock";
+    }
+    return QString("PictureView-%1").arg(qEnvironmentVariable("USER"));
+#endif
+}
+
+bool SingleInstance::sendToRunning(const QStringList &paths, int timeoutMs)
+{
+    PV_TRACE_SCOPE_CAT("singleInstance.send", "startup");
+    QLocalSocket socket;
+    socket.connectToServer(serverName());
+    if (!socket.waitForConnected(timeoutMs)) {
+        return false;
+    }
+
+    QByteArray line = QJsonDocument(QJsonObject{{"open", QJsonArray::fromStringList(paths)}})
+                          .toJson(QJsonDocument::Compact);
+    line += '\n';
+    socket.write(line);
+    if (!socket.waitForBytesWritten(timeoutMs)) {
+        qWarning() << "单实例：发送失败" << socket.errorString();
+        return false;
+    }
+    socket.disconnectFromServer();
+    if (socket.state() != QLocalSocket::UnconnectedState) {
+        socket.waitForDisconnected(timeoutMs);
+    }
+    return true;
+}
+
+SingleInstance::StartResult SingleInstance::start(const QStringList &paths)
+{
+    PV_TRACE_SCOPE_CAT("singleInstance.start", "startup");
+    // "检查是否有实例 → 监听" 必须是原子的：同时启动的进程在这里排队，
+    // 第一个建好监听后释放锁，后面的进程都能转发成功
+    const QString name = serverName();
+    const QString lockPath = QDir::isAbsolutePath(name) ? name + ".lock"
+                                                        : QDir::temp().filePath(name + ".lock");
+    QLockFile lock(lockPath);
+    lock.setStaleLockTime(10000);
+    if (!lock.tryLock(2000)) {
+        qWarning() << "单实例：无法获得锁" << lockPath;
+    }
+
+    if (sendToRunning(paths)) {
+        return Forwarded;
+    }
+    return listen() ? Primary : Standalone;
+}
+
+bool SingleInstance::listen()
+{
+    const QString name = serverName();
+    if (m_server->listen(name)) {
+        qCDebug(lcApp) << "单实例监听:" << m_server->fullServerName();
+        return true;
+    }
+
+    // 持有锁且刚才转发失败（监听中的实例即使还没进入事件循环，连接也会被内核接受），
+    // 剩下的只可能是崩溃后残留的套接字文件
+    if (m_server->serverError() == QAbstractSocket::AddressInUseError) {
+        QLocalServer::removeServer(name);
+        if (m_server->listen(name)) {
+            qCDebug(lcApp) << "单实例监听（已清理残留套接字）:" << m_server->fullServerName();
+            return true;
+        }
+    }
+    qWarning() << "单实例：无法监听" << name << m_server->errorString();
+    return false;
+}
+
+void SingleInstance::handleNewConnection()
+{
+    while (QLocalSocket *socket = m_server->nextPendingConnection()) {
+        // 客户端写完即断开，数据可能分几次到达，按行读取；
+        // 启动期间排队的连接在取出时可能已经收完数据并断开
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]() { drain(socket); });
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket]() {
+            drain(socket);
+            socket->deleteLater();
+        });
+        drain(socket);
+        if (socket->state() == QLocalSocket::UnconnectedState) {
+            socket->deleteLater();
+        }
+    }
+}
+
+void SingleInstance::drain(QLocalSocket *socket)
+{
+    while (socket->canReadLine()) {
+        handleLine(socket->readLine());
+    }
+    if (socket->bytesAvailable() > kMaxRequestBytes) {
+        qWarning() << "单实例：请求过长，已断开";
+        socket->abort();
+    }
+}
+
+void SingleInstance::handleLine(const QByteArray &line)
+{
+    QJsonParseError error;
+    const QJsonDocument document = QJsonDocument::fromJson(line, &error);
+    if (error.error != QJsonParseError::NoError || !document.isObject()) {
+        qWarning() << "单实例：无法解析请求" << error.errorString();
+        return;
+    }
+
+    const QJsonArray paths = document.object().value("open").toArray();
+    qCDebug(lcApp) << "单实例：收到打开请求" << paths.size() << "个路径";
+    if (paths.isEmpty()) {
+        emit openRequested(QString());
+        return;
+    }
+    for (const QJsonValue &path : paths) {
+        emit openRequested(path.toString());
+    }
+}
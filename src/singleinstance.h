@@ -0,0 +1,60 @@
+// singleinstance.h
+#ifndef SINGLEINSTANCE_H
+#define SINGLEINSTANCE_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+class QLocalServer;
+class QLocalSocket;
+
+// 单实例：第一个启动的进程在每用户的本地套接字上监听，之后的启动（文件管理器双击、
+// 命令行）只把路径发过去就退出，由已运行的进程在同一进程内打开新窗口，
+// 共用原图缓存、缩略图缓存和线程池，省去冷启动（翻译、配置、空缓存）。
+//
+// 协议：客户端写一行紧凑 JSON {"open":["/abs/path", ...]}，写完即断开。
+// 空列表表示"打开一个新窗口"。
+//
+// 文件管理器一次打开多个选中文件时会同时启动多个进程：start() 在锁文件保护下
+// "转发或监听"，保证只有一个进程成为主实例，也不会删掉别人刚建好的套接字。
+// 应在解析完命令行后立即调用；监听建立后连接由内核排队，事件循环开始后再处理。
+class SingleInstance : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SingleInstance(QObject *parent = nullptr);
+    ~SingleInstance();
+
+    // 每用户唯一的服务名（Unix 上优先放在 XDG_RUNTIME_DIR 下）
+    static QString serverName();
+
+    // 把路径交给已运行的实例（路径应为绝对路径）；没有实例在监听时返回 false
+    static bool sendToRunning(const QStringList &paths, int timeoutMs = 500);
+
+    enum StartResult {
+        Primary,      // 本进程在监听，之后的启动会转发到这里
+        Forwarded,    // 路径已交给运行中的实例，本进程应退出
+        Standalone    // 无法监听也无法转发，作为普通进程继续运行
+    };
+
+    // 已有实例在运行则转发路径，否则开始监听（清理上次异常退出留下的套接字）
+    StartResult start(const QStringList &paths);
+
+signals:
+    // 空路径表示只需打开一个新窗口
+    void openRequested(const QString &path);
+
+private slots:
+    void handleNewConnection();
+
+private:
+    bool listen();
+    void drain(QLocalSocket *socket);
+    void handleLine(const QByteArray &line);
+
+    QLocalServer *m_server;
+};
+
+#endif // SINGLEINSTANCE_H
@@ -0,0 +1,78 @@
+// startuptimer.cpp
+#include "startuptimer.h"
+#include "trace.h"
+#include <QMutex>
+#include <QVector>
+#include <QDebug>
+#include <atomic>
+#include <cstring>
+
+namespace StartupTimer
+{
+namespace
+{
+
+struct Milestone {
+    const char *name;
+    qint64 timeNs;
+};
+
+std::atomic<bool> s_enabled{false};
+QMutex s_mutex;
+QVector<Milestone> s_milestones;
+
+} // namespace
+
+bool enableFromArguments(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--measure-startup") == 0) {
+            s_enabled.store(true, std::memory_order_relaxed);
+            mark("main");
+            return true;
+        }
+    }
+    return false;
+}
+
+bool isEnabled()
+{
+    return s_enabled.load(std::memory_order_relaxed);
+}
+
+void mark(const char *milestone)
+{
+    if (!isEnabled()) return;
+    const qint64 now = Trace::now();
+    {
+        QMutexLocker locker(&s_mutex);
+        for (const Milestone &existing : std::as_const(s_milestones)) {
+            if (std::strcmp(existing.name, milestone) == 0) return;
+        }
+        s_milestones.append({milestone, now});
+    }
+    if (Trace::isEnabled()) {
+        Trace::record(milestone, "startup", now, 0);
+    }
+}
+
+void finish(const char *milestone)
+{
+    if (!isEnabled()) return;
+    mark(milestone);
+    s_enabled.store(false, std::memory_order_relaxed);
+
+    QMutexLocker locker(&s_mutex);
+    // 时间起点是进程静态初始化，包含动态链接之后的全部启动开销
+    qInfo().noquote() << "启动耗时（自进程启动）:";
+    qint64 previous = 0;
+    for (const Milestone &m : std::as_const(s_milestones)) {
+        qInfo().noquote() << QString("  %1 %2 ms  (+%3 ms)")
+                                 .arg(QLatin1String(m.name), -20)
+                                 .arg(m.timeNs / 1e6, 8, 'f', 2)
+                                 .arg((m.timeNs - previous) / 1e6, 0, 'f', 2);
+        previous = m.timeNs;
+    }
+}
+
+} // namespace StartupTimer
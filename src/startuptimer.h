@@ -0,0 +1,24 @@
+// startuptimer.h
+#ifndef STARTUPTIMER_H
+#define STARTUPTIMER_H
+
+// 冷启动里程碑（--measure-startup）：记录从进程启动（静态初始化）到各阶段的耗时，
+// 第一帧绘制后一次性输出。未启用时 mark() 只有一次原子读取的开销。
+// 启用跟踪（--trace）时里程碑同时写成 "startup" 分类的事件。
+//
+//   StartupTimer::mark("widget");
+namespace StartupTimer
+{
+    // 从命令行取出 --measure-startup 并启用，返回是否启用
+    bool enableFromArguments(int argc, char *argv[]);
+
+    bool isEnabled();
+
+    // 名称必须是字符串字面量（只保存指针）；同名里程碑只记录第一次
+    void mark(const char *milestone);
+
+    // 记录最后一个里程碑并输出报告，之后不再记录
+    void finish(const char *milestone);
+}
+
+#endif // STARTUPTIMER_H
@@ -0,0 +1,54 @@
+// threadpools.cpp
+#include "threadpools.h"
+#include <QThreadPool>
+#include <QThread>
+#include <QtGlobal>
+
+// I/O 线程数：核心数的 2 倍，至少 4、至多 16
+static int ioThreadCount()
+{
+    return qBound(4, QThread::idealThreadCount() * 2, 16);
+}
+
+static QThreadPool *createPool(const QString &name, int maxThreads, QThread::Priority priority)
+{
+    // 不随静态析构释放（由 shutdown() 清空），避免退出时与 QCoreApplication 的析构顺序问题
+    QThreadPool *pool = new QThreadPool;
+    pool->setObjectName(name);
+    pool->setMaxThreadCount(maxThreads);
+    // 空闲线程保留 30 秒，浏览过程中不反复创建线程
+    pool->setExpiryTimeout(30000);
+#if QT_VERSION >= QT_VERSION_CHECK(6, 2, 0)
+    pool->setThreadPriority(priority);
+#else
+    Q_UNUSED(priority);
+#endif
+    return pool;
+}
+
+QThreadPool *ThreadPools::io()
+{
+    static QThreadPool *pool = createPool("PictureView-IO", ioThreadCount(), QThread::NormalPriority);
+    return pool;
+}
+
+QThreadPool *ThreadPools::cpu()
+{
+    static QThreadPool *pool = createPool("PictureView-CPU", qMax(1, QThread::idealThreadCount()),
+                                          QThread::NormalPriority);
+    return pool;
+}
+
+QThreadPool *ThreadPools::idle()
+{
+    static QThreadPool *pool = createPool("PictureView-Idle", 1, QThread::LowestPriority);
+    return pool;
+}
+
+void ThreadPools::shutdown()
+{
+    for (QThreadPool *pool : {idle(), io(), cpu()}) {
+        pool->clear();
+        pool->waitForDone();
+    }
+}
@@ -0,0 +1,30 @@
+// threadpools.h
+#ifndef THREADPOOLS_H
+#define THREADPOOLS_H
+
+class QThreadPool;
+
+// 按用途划分的后台线程池，替代 QThreadPool::globalInstance()：
+//   I/O 池  —— 读文件/解压，线程数多于核心数，用来掩盖磁盘和网络盘的等待
+//   CPU 池  —— 解码/缩放，线程数等于核心数
+//   空闲池  —— 预热和重试等可有可无的工作，单线程、低优先级，不与前两者争抢
+// 慢速读取只会占住 I/O 线程，不会挡住解码；重试风暴也挤不掉下一张图片的预加载。
+class ThreadPools
+{
+public:
+    // 任务优先级（QThreadPool::start 的 priority 参数，数值越大越先执行）
+    enum Priority {
+        PriorityBackground = 0,   // 后台预热：不可见的缩略图
+        PriorityNextImage = 5,    // 幻灯片/浏览的下一张图片
+        PriorityVisible = 10      // 当前可见的缩略图
+    };
+
+    static QThreadPool *io();
+    static QThreadPool *cpu();
+    static QThreadPool *idle();
+
+    // 程序退出前调用：丢弃排队中的任务并等待正在执行的任务结束
+    static void shutdown();
+};
+
+#endif // THREADPOOLS_H
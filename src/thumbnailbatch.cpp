@@ -0,0 +1,228 @@
+// thumbnailbatch.cpp
+#include "thumbnailbatch.h"
+#include "thumbnailloader.h"
+#include "thumbnaildiskcache.h"
+#include "configmanager.h"
+#include "threadpools.h"
+#include "archivehandler.h"
+#include "formatsniffer.h"
+#include "directoryscanner.h"
+#include "logging.h"
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QDir>
+#include <QSemaphore>
+#include <QThreadPool>
+#include <QTextStream>
+#include <QDebug>
+#include <atomic>
+#include <cstring>
+
+namespace {
+
+struct BatchStats {
+    std::atomic<int> generated{0};
+    std::atomic<int> cached{0};
+    std::atomic<int> failed{0};
+    std::atomic<qint64> bytesRead{0};
+};
+
+class BatchRunner
+{
+public:
+    explicit BatchRunner(const QSize &size)
+        : size(size),
+          // 同时在途的任务数：够所有 CPU 线程忙，又不至于把整个目录读进内存
+          capacity(ThreadPools::cpu()->maxThreadCount() * 2),
+          inFlight(capacity)
+    {
+    }
+
+    void addFile(const QString &path)
+    {
+        inFlight.acquire();
+        ThreadPools::io()->start([this, path]() {
+            if (ThumbnailDiskCache::contains(path, size)) {
+                ++stats.cached;
+                inFlight.release();
+                return;
+            }
+
+            QString error;
+            QByteArray data = ThumbnailLoader::readSource(path, CancellationToken(), &error);
+            if (data.isEmpty()) {
+                qCDebug(lcThumbnail) << "读取失败:" << path << error;
+                ++stats.failed;
+                inFlight.release();
+                return;
+            }
+            stats.bytesRead += data.size();
+
+            ThreadPools::cpu()->start([this, path, data]() {
+                decodeAndStore(path, data);
+                inFlight.release();
+            });
+        });
+    }
+
+    // 压缩包只遍历一次，解压在当前线程进行，解码交给 CPU 池
+    void addArchive(const QString &archivePath)
+    {
+        ArchiveHandler handler;
+        if (!handler.openArchive(archivePath)) {
+            ++stats.failed;
+            return;
+        }
+
+        handler.forEachImage(
+            [this, &archivePath](const QString &name) {
+                if (ThumbnailDiskCache::contains(archivePath + "|" + name, size)) {
+                    ++stats.cached;
+                    return false;
+                }
+                return true;
+            },
+            [this, &archivePath](const QString &name, const QByteArray &data) {
+                stats.bytesRead += data.size();
+                const QString path = archivePath + "|" + name;
+                inFlight.acquire();
+                ThreadPools::cpu()->start([this, path, data]() {
+                    decodeAndStore(path, data);
+                    inFlight.release();
+                });
+                return true;
+            });
+    }
+
+    void waitForDone()
+    {
+        inFlight.acquire(capacity);
+        inFlight.release(capacity);
+    }
+
+    BatchStats stats;
+
+private:
+    void decodeAndStore(const QString &path, const QByteArray &data)
+    {
+        QString error;
+        QImage image = ThumbnailLoader::decodeThumbnail(data, path, size, CancellationToken(), &error);
+        if (image.isNull() || !ThumbnailDiskCache::store(path, size, image)) {
+            qCDebug(lcThumbnail) << "缩略图生成失败:" << path << error;
+            ++stats.failed;
+            return;
+        }
+        ++stats.generated;
+    }
+
+    const QSize size;
+    const int capacity;
+    QSemaphore inFlight;
+};
+
+} // namespace
+
+bool ThumbnailBatch::isRequested(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--generate-thumbnails") == 0
+            || std::strncmp(argv[i], "--generate-thumbnails=", 22) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int ThumbnailBatch::run(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Generate thumbnails into the disk cache without opening a window");
+    parser.addHelpOption();
+    QCommandLineOption generateOption("generate-thumbnails", "Folder or archive to process", "path");
+    // 与缩略图视图的默认尺寸一致，否则界面用不上生成的缓存
+    QCommandLineOption sizeOption("thumbnail-size", "Thumbnail edge length in pixels", "pixels", "250");
+    // 未指定时使用配置文件里的 [Cache] ThumbnailLimitMB，与界面模式共用同一个上限
+    QCommandLineOption cacheLimitOption("cache-limit", "Disk cache size limit in megabytes", "MB");
+    // 由 main() 处理，这里只登记
+    QCommandLineOption traceOption("trace", "Write a Chrome trace (JSON) to this file on exit", "file");
+    parser.addOption(generateOption);
+    parser.addOption(sizeOption);
+    parser.addOption(cacheLimitOption);
+    parser.addOption(traceOption);
+    parser.process(arguments);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QFileInfo target(parser.value(generateOption));
+    const int edge = parser.value(sizeOption).toInt();
+    if (!target.exists() || edge <= 0) {
+        err << "Invalid path or thumbnail size: " << target.filePath() << Qt::endl;
+        return 1;
+    }
+
+    QStringList files;
+    QStringList archives;
+    if (target.isDir()) {
+        const QStringList paths = DirectoryScanner::listAbsolutePaths(QDir(target.absoluteFilePath()));
+        for (const QString &path : paths) {
+            if (FormatSniffer::isArchiveFile(path)) {
+                archives.append(path);
+            } else {
+                files.append(path);
+            }
+        }
+    } else if (FormatSniffer::isArchiveFile(target.absoluteFilePath())) {
+        archives.append(target.absoluteFilePath());
+    } else {
+        files.append(target.absoluteFilePath());
+    }
+
+    int cacheLimitMB = ConfigManager().loadConfig().thumbnailCacheLimitMB;
+    if (parser.isSet(cacheLimitOption)) {
+        bool ok = false;
+        cacheLimitMB = parser.value(cacheLimitOption).toInt(&ok);
+        if (!ok || cacheLimitMB < 0) {
+            err << "Invalid cache limit: " << parser.value(cacheLimitOption) << Qt::endl;
+            return 1;
+        }
+    }
+    // 先统计一次：之后写入超出上限时 store() 会在空闲池安排清理
+    ThumbnailDiskCache::setSizeLimit(qint64(cacheLimitMB) * 1024 * 1024);
+    ThumbnailDiskCache::prune();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    BatchRunner runner(QSize(edge, edge));
+    for (const QString &path : files) {
+        runner.addFile(path);
+    }
+    for (const QString &path : archives) {
+        runner.addArchive(path);
+    }
+    runner.waitForDone();
+    // 定时预热任务结束前同步清理，保证退出时缓存不超过上限
+    const qint64 cacheBytes = ThumbnailDiskCache::prune();
+
+    const double seconds = qMax<qint64>(1, timer.elapsed()) / 1000.0;
+    const int generated = runner.stats.generated.load();
+    const int cached = runner.stats.cached.load();
+    const int failed = runner.stats.failed.load();
+    const double megabytes = runner.stats.bytesRead.load() / (1024.0 * 1024.0);
+
+    out << "Thumbnails: " << (generated + cached + failed) << " total, " << generated << " generated, "
+        << cached << " already cached, " << failed << " failed" << Qt::endl;
+    out << QString("Elapsed %1 s, %2 thumbnails/s, read %3 MB (%4 MB/s), %5 CPU threads")
+               .arg(seconds, 0, 'f', 2)
+               .arg(generated / seconds, 0, 'f', 1)
+               .arg(megabytes, 0, 'f', 1)
+               .arg(megabytes / seconds, 0, 'f', 1)
+               .arg(ThreadPools::cpu()->maxThreadCount())
+        << Qt::endl;
+    out << "Cache: " << ThumbnailDiskCache::cacheDir()
+        << QString(" (%1 MB of %2 MB)").arg(cacheBytes / (1024.0 * 1024.0), 0, 'f', 1).arg(cacheLimitMB)
+        << Qt::endl;
+    return 0;
+}
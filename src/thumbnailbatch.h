@@ -0,0 +1,20 @@
+// thumbnailbatch.h
+#ifndef THUMBNAILBATCH_H
+#define THUMBNAILBATCH_H
+
+#include <QStringList>
+
+// 无窗口批量生成缩略图（--generate-thumbnails <目录|压缩包>）：
+// 走与缩略图视图相同的 I/O 池 → CPU 池流水线，结果写入磁盘缓存，
+// 结束时输出吞吐量。用于在服务器上预热缓存，也可作为可复现的性能测试。
+class ThumbnailBatch
+{
+public:
+    // 在创建 QApplication 之前判断，批量模式只需要 QCoreApplication
+    static bool isRequested(int argc, char *argv[]);
+
+    // 返回进程退出码
+    static int run(const QStringList &arguments);
+};
+
+#endif // THUMBNAILBATCH_H
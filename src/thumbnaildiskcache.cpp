@@ -0,0 +1,173 @@
+// thumbnaildiskcache.cpp
+#include "thumbnaildiskcache.h"
+#include "logging.h"
+#include "trace.h"
+#include "metrics.h"
+#include "threadpools.h"
+#include <QStandardPaths>
+#include <QCryptographicHash>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDir>
+#include <QSaveFile>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QThreadPool>
+#include <QDebug>
+#include <atomic>
+
+namespace {
+
+std::atomic<qint64> s_sizeLimit{512LL * 1024 * 1024};
+// 目录总占用：-1 表示还没有统计过（第一次 prune 之前不触发清理）
+std::atomic<qint64> s_totalBytes{-1};
+std::atomic<bool> s_pruning{false};
+
+// 命中的条目超过这么久没刷新过修改时间才刷新，避免每次读取都写元数据
+const qint64 kTouchIntervalSecs = 60 * 60;
+
+} // namespace
+
+QString ThumbnailDiskCache::cacheDir()
+{
+    static const QString dir = [] {
+        QString path = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/thumbnails";
+        QDir().mkpath(path);
+        return path;
+    }();
+    return dir;
+}
+
+QString ThumbnailDiskCache::cacheFilePath(const QString &path, const QSize &size)
+{
+    const int separator = path.indexOf('|');
+    QFileInfo source(separator >= 0 ? path.left(separator) : path);
+    if (!source.exists()) return QString();
+
+    const QString key = QString("%1\n%2\n%3\n%4x%5")
+                            .arg(path)
+                            .arg(source.lastModified().toMSecsSinceEpoch())
+                            .arg(source.size())
+                            .arg(size.width())
+                            .arg(size.height());
+    const QByteArray hash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return cacheDir() + "/" + QString::fromLatin1(hash) + ".thumb";
+}
+
+QImage ThumbnailDiskCache::load(const QString &path, const QSize &size)
+{
+    PV_TRACE_SCOPE_CAT("diskCacheLoad", "cache");
+    const QString filePath = cacheFilePath(path, size);
+    if (filePath.isEmpty()) return QImage();   // 压缩包条目等不可缓存的来源，不计入命中率
+    if (!QFileInfo::exists(filePath)) {
+        Metrics::cacheMiss(Metrics::DiskTier);
+        return QImage();
+    }
+
+    // 格式由内容判断（有透明通道的存 PNG，其余存 JPEG）
+    QImageReader reader(filePath);
+    QImage image;
+    if (!reader.read(&image)) {
+        qCDebug(lcThumbnail) << "缩略图缓存损坏，删除:" << filePath << reader.errorString();
+        QFile::remove(filePath);
+        Metrics::cacheMiss(Metrics::DiskTier);
+        return QImage();
+    }
+    Metrics::cacheHit(Metrics::DiskTier);
+
+    // 修改时间用作最后使用时间，清理时先删最久没用过的
+    const QDateTime now = QDateTime::currentDateTime();
+    if (QFileInfo(filePath).lastModified().secsTo(now) > kTouchIntervalSecs) {
+        QFile file(filePath);
+        if (file.open(QIODevice::ReadWrite | QIODevice::ExistingOnly)) {
+            file.setFileTime(now, QFileDevice::FileModificationTime);
+        }
+    }
+    return image;
+}
+
+bool ThumbnailDiskCache::contains(const QString &path, const QSize &size)
+{
+    const QString filePath = cacheFilePath(path, size);
+    return !filePath.isEmpty() && QFileInfo::exists(filePath);
+}
+
+bool ThumbnailDiskCache::store(const QString &path, const QSize &size, const QImage &image)
+{
+    PV_TRACE_SCOPE_CAT("diskCacheStore", "cache");
+    if (image.isNull()) return false;
+
+    const QString filePath = cacheFilePath(path, size);
+    if (filePath.isEmpty()) return false;
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+
+    const bool hasAlpha = image.hasAlphaChannel();
+    QImageWriter writer(&file, hasAlpha ? "png" : "jpg");
+    writer.setQuality(hasAlpha ? 50 : 90);
+    if (!writer.write(image)) {
+        qCDebug(lcThumbnail) << "写入缩略图缓存失败:" << filePath << writer.errorString();
+        file.cancelWriting();
+        return false;
+    }
+    const qint64 written = file.size();
+    if (!file.commit()) return false;
+    Metrics::addCacheBytes(Metrics::DiskTier, written);
+
+    // 覆盖已有条目时会多算一些，下一次 prune 重新统计
+    if (s_totalBytes.load() >= 0 && (s_totalBytes += written) > s_sizeLimit.load()) {
+        pruneAsync();
+    }
+    return true;
+}
+
+qint64 ThumbnailDiskCache::sizeLimit()
+{
+    return s_sizeLimit.load();
+}
+
+void ThumbnailDiskCache::setSizeLimit(qint64 bytes)
+{
+    s_sizeLimit = qMax<qint64>(0, bytes);
+}
+
+void ThumbnailDiskCache::pruneAsync()
+{
+    if (s_pruning.exchange(true)) return;
+    ThreadPools::idle()->start([]() {
+        prune();
+        s_pruning = false;
+    }, ThreadPools::PriorityBackground);
+}
+
+qint64 ThumbnailDiskCache::prune()
+{
+    PV_TRACE_SCOPE_CAT("diskCachePrune", "cache");
+    // 按修改时间从旧到新
+    const QFileInfoList entries = QDir(cacheDir()).entryInfoList(
+        QStringList() << "*.thumb", QDir::Files, QDir::Time | QDir::Reversed);
+
+    qint64 total = 0;
+    for (const QFileInfo &entry : entries) {
+        total += entry.size();
+    }
+
+    const qint64 limit = s_sizeLimit.load();
+    if (total > limit) {
+        const qint64 target = limit / 10 * 9;
+        int removed = 0;
+        for (const QFileInfo &entry : entries) {
+            if (total <= target) break;
+            if (QFile::remove(entry.absoluteFilePath())) {
+                total -= entry.size();
+                ++removed;
+            }
+        }
+        qCDebug(lcThumbnail) << "缩略图磁盘缓存清理:" << removed << "个条目，剩余" << total << "字节";
+    }
+
+    s_totalBytes = total;
+    Metrics::setCacheBytes(Metrics::DiskTier, total);
+    return total;
+}
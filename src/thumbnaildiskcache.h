@@ -0,0 +1,36 @@
+// thumbnaildiskcache.h
+#ifndef THUMBNAILDISKCACHE_H
+#define THUMBNAILDISKCACHE_H
+
+#include <QString>
+#include <QImage>
+#include <QSize>
+
+// 缩略图磁盘缓存：缩放后的缩略图保存在 <缓存目录>/thumbnails 下，
+// 文件名是 (路径, 修改时间, 文件大小, 缩略图尺寸) 的哈希，源文件修改后自动失效。
+// 压缩包条目按压缩包本身的修改时间和大小计算。可在任意线程调用。
+// 总占用超过上限时按最后使用时间（命中时刷新文件修改时间）删除最旧的条目。
+class ThumbnailDiskCache
+{
+public:
+    static QString cacheDir();
+
+    // path 为普通文件的绝对路径，或 "压缩包路径|内部路径"；未命中返回空图
+    static QImage load(const QString &path, const QSize &size);
+    static bool contains(const QString &path, const QSize &size);
+    // 写入临时文件后原子替换，并发写同一条目也不会读到半个文件
+    static bool store(const QString &path, const QSize &size, const QImage &image);
+
+    // 磁盘占用上限（字节），默认 512MB，由配置文件 [Cache] ThumbnailLimitMB 设置
+    static qint64 sizeLimit();
+    static void setSizeLimit(qint64 bytes);
+    // 在空闲线程池统计并清理（启动时和写入超出上限时），同一时间只运行一个
+    static void pruneAsync();
+    // 同步清理到上限的 90% 以下，返回清理后的总占用
+    static qint64 prune();
+
+private:
+    static QString cacheFilePath(const QString &path, const QSize &size);
+};
+
+#endif // THUMBNAILDISKCACHE_H
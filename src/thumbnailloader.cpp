@@ -0,0 +1,193 @@
+// thumbnailloader.cpp
+#include "thumbnailloader.h"
+#include "logging.h"
+#include "trace.h"
+#include "archivehandler.h"
+#include "formatsniffer.h"
+#include <QFileInfo>
+#include <QImageReader>
+#include <QBuffer>
+#include <QFile>
+#include <QDebug>
+
+ThumbnailLoader::Result ThumbnailLoader::loadThumbnail(const QString &path, const QSize &size,
+                                                       const CancellationToken &token)
+{
+    Result result;
+
+    int separator = path.indexOf('|');
+    if (separator >= 0) {
+        // 压缩包内部文件
+        QImage image = decodeArchiveEntry(path.left(separator), path.mid(separator + 1),
+                                          token, &result.error);
+        if (token.isCancelled()) {
+            result.cancelled = true;
+            return result;
+        }
+        result.image = scaleImageWithAspectRatio(image, size);
+    } else {
+        result.image = loadImageFileFast(path, size, token, &result.error);
+    }
+
+    result.cancelled = token.isCancelled();
+    return result;
+}
+
+QImage ThumbnailLoader::decodeFile(const QString &filePath, const CancellationToken &token,
+                                   QString *error, bool autoTransform)
+{
+    PV_TRACE_SCOPE_CAT("decodeFile", "decode");
+    auto fail = [error](const QString &reason) {
+        if (error) *error = reason;
+        return QImage();
+    };
+
+    if (token.isCancelled()) return QImage();
+
+    // 已知解码失败且未修改过的文件不再重试
+    if (FormatSniffer::hasDecodeFailed(filePath)) {
+        return fail("图片文件加载失败");
+    }
+
+    // 阶段 1：I/O —— 读取文件头确定格式
+    FormatSniffer::Format format = FormatSniffer::detect(filePath);
+    if (!FormatSniffer::isImage(format)) {
+        qCDebug(lcDecode) << "不是支持的图片格式:" << filePath;
+        FormatSniffer::markDecodeFailed(filePath);
+        return fail("不是支持的图片格式");
+    }
+    if (token.isCancelled()) return QImage();
+
+    // 阶段 2：解码 —— 直接使用对应的解码器，只解码一次
+    QImageReader reader(filePath, FormatSniffer::decoderFormat(format));
+    reader.setAutoTransform(autoTransform);
+
+    QImage image;
+    if (!reader.read(&image) || image.isNull()) {
+        qCDebug(lcDecode) << "图片解码失败:" << filePath << "格式:" << reader.format() << "错误:" << reader.errorString();
+        FormatSniffer::markDecodeFailed(filePath);
+        return fail("图片文件加载失败");
+    }
+    return image;
+}
+
+QImage ThumbnailLoader::decodeArchiveEntry(const QString &archivePath, const QString &entryName,
+                                           const CancellationToken &token, QString *error)
+{
+    // 每次使用独立的 ArchiveHandler，不与界面共用 libarchive 句柄
+    const QString path = archivePath + "|" + entryName;
+    return decodeData(readSource(path, token, error), path, token, error);
+}
+
+QByteArray ThumbnailLoader::readSource(const QString &path, const CancellationToken &token, QString *error)
+{
+    PV_TRACE_SCOPE_CAT("readSource", "io");
+    if (token.isCancelled()) return QByteArray();
+
+    int separator = path.indexOf('|');
+    if (separator >= 0) {
+        ArchiveHandler handler;
+        if (!handler.openArchive(path.left(separator))) {
+            if (error) *error = "压缩包打开失败";
+            return QByteArray();
+        }
+        QByteArray data = handler.extractFile(path.mid(separator + 1));
+        if (data.isEmpty() && error) *error = "压缩包缩略图获取失败";
+        return data;
+    }
+
+    if (FormatSniffer::hasDecodeFailed(path)) {
+        if (error) *error = "图片文件加载失败";
+        return QByteArray();
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = file.exists() ? "图片文件加载失败" : "文件不存在";
+        return QByteArray();
+    }
+    QByteArray data = file.readAll();
+    if (data.isEmpty() && error) *error = "图片文件加载失败";
+    return data;
+}
+
+QImage ThumbnailLoader::decodeData(const QByteArray &data, const QString &path,
+                                   const CancellationToken &token, QString *error, bool autoTransform)
+{
+    PV_TRACE_SCOPE_CAT("decodeData", "decode");
+    if (data.isEmpty() || token.isCancelled()) return QImage();
+
+    const bool isArchiveEntry = path.contains('|');
+
+    QBuffer buffer;
+    buffer.setData(data);
+    buffer.open(QIODevice::ReadOnly);
+    QImageReader reader(&buffer, decoderFormatFor(data, path));
+    reader.setAutoTransform(autoTransform);
+
+    QImage image;
+    if (!reader.read(&image) || image.isNull()) {
+        qCDebug(lcDecode) << "图片解码失败:" << path << "错误:" << reader.errorString();
+        if (!isArchiveEntry) {
+            FormatSniffer::markDecodeFailed(path);
+        }
+        if (error) *error = isArchiveEntry ? "压缩包缩略图获取失败" : "图片文件加载失败";
+        return QImage();
+    }
+    return image;
+}
+
+QImage ThumbnailLoader::decodeThumbnail(const QByteArray &data, const QString &path, const QSize &size,
+                                        const CancellationToken &token, QString *error)
+{
+    PV_TRACE_SCOPE_CAT("decodeThumbnail", "decode");
+    if (data.isEmpty() || token.isCancelled()) return QImage();
+
+    QImage image = decodeData(data, path, token, error, true);
+    if (image.isNull() || token.isCancelled()) return QImage();
+    return scaleImageWithAspectRatio(image, size);
+}
+
+QByteArray ThumbnailLoader::decoderFormatFor(const QByteArray &data, const QString &path)
+{
+    FormatSniffer::Format format = FormatSniffer::fromHeader(data.left(FormatSniffer::kHeaderSize));
+    if (!FormatSniffer::isImage(format)) {
+        // 魔数无法识别时按扩展名选择，仍未知则交给 QImageReader 自动判断
+        format = FormatSniffer::fromFileName(path);
+    }
+    return FormatSniffer::decoderFormat(format);
+}
+
+// 高效图片加载
+QImage ThumbnailLoader::loadImageFileFast(const QString &filePath, const QSize &size,
+                                          const CancellationToken &token, QString *error)
+{
+    // 检查文件是否存在和可读
+    QFileInfo fileInfo(filePath);
+    if (!fileInfo.exists()) {
+        qCDebug(lcDecode) << "文件不存在:" << filePath;
+        if (error) *error = "文件不存在";
+        return QImage();
+    }
+
+    if (!fileInfo.isReadable() || fileInfo.size() == 0) {
+        qCDebug(lcDecode) << "文件不可读或大小为0:" << filePath;
+        if (error) *error = "图片文件加载失败";
+        return QImage();
+    }
+
+    QImage image = decodeFile(filePath, token, error, true);
+    if (image.isNull() || token.isCancelled()) return QImage();
+
+    // 阶段 3：缩放 —— 保持宽高比
+    return scaleImageWithAspectRatio(image, size);
+}
+
+QImage ThumbnailLoader::scaleImageWithAspectRatio(const QImage &original, const QSize &size)
+{
+    PV_TRACE_SCOPE_CAT("scale", "scale");
+    if (original.isNull()) return QImage();
+
+    // 保持宽高比进行缩放
+    return original.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+}
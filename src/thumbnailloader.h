@@ -0,0 +1,53 @@
+// thumbnailloader.h
+#ifndef THUMBNAILLOADER_H
+#define THUMBNAILLOADER_H
+
+#include <QString>
+#include <QImage>
+#include <QSize>
+#include "cancellationtoken.h"
+
+// 后台解码函数：只使用 QImage，不访问任何窗口对象和缓存，可在任意线程调用。
+// 在 I/O、解码、缩放各阶段之间检查取消令牌，切换目录后旧任务尽快让出线程。
+class ThumbnailLoader
+{
+public:
+    struct Result {
+        QImage image;
+        QString error;          // 失败原因（image 为空时有效）
+        bool cancelled = false;
+    };
+
+    // path 为普通文件的绝对路径，或 "压缩包路径|内部路径"
+    static Result loadThumbnail(const QString &path, const QSize &size,
+                                const CancellationToken &token = CancellationToken());
+
+    // 分阶段接口：I/O 阶段（读文件或解压条目）和解码阶段可以放到不同的线程池
+    static QByteArray readSource(const QString &path, const CancellationToken &token = CancellationToken(),
+                                 QString *error = nullptr);
+    static QImage decodeData(const QByteArray &data, const QString &path,
+                             const CancellationToken &token = CancellationToken(),
+                             QString *error = nullptr, bool autoTransform = false);
+    // 解码并缩放到缩略图尺寸
+    static QImage decodeThumbnail(const QByteArray &data, const QString &path, const QSize &size,
+                                  const CancellationToken &token = CancellationToken(),
+                                  QString *error = nullptr);
+
+    // 原尺寸解码（幻灯片预加载等）
+    static QImage decodeFile(const QString &filePath,
+                             const CancellationToken &token = CancellationToken(),
+                             QString *error = nullptr, bool autoTransform = false);
+    static QImage decodeArchiveEntry(const QString &archivePath, const QString &entryName,
+                                     const CancellationToken &token = CancellationToken(),
+                                     QString *error = nullptr);
+
+    static QImage loadImageFileFast(const QString &filePath, const QSize &size,
+                                    const CancellationToken &token = CancellationToken(),
+                                    QString *error = nullptr);
+    static QImage scaleImageWithAspectRatio(const QImage &original, const QSize &size);
+
+private:
+    static QByteArray decoderFormatFor(const QByteArray &data, const QString &path);
+};
+
+#endif // THUMBNAILLOADER_H
@@ -1,4 +1,7 @@
 #include "thumbnailwidget.h"
+#include "logging.h"
+#include "trace.h"
+#include "metrics.h"
 #include <QPainter>
 #include <QMouseEvent>
 #include <QFileInfo>
@@ -6,6 +9,8 @@
 #include <QFutureWatcher>
 #include <QtConcurrent>
 #include "imagewidget.h"
+#include "formatsniffer.h"
+#include "thumbnaildiskcache.h"
 #include <QPainterPath>
 #include <QScrollArea>
 #include <QElapsedTimer>
@@ -13,6 +18,13 @@
 #include <QCache>
 #include <QTimer>
 #include <QFont>
+#include <QSemaphore>
+#include "archivehandler.h"
+#include <limits>
+
+// 失败重试：最多尝试 kMaxLoadAttempts 次，间隔从 kRetryBaseDelayMs 起每次乘 4
+static const int kMaxLoadAttempts = 3;
+static const int kRetryBaseDelayMs = 2000;
 
 // 初始化静态成员变量
 QMap<QString, QPixmap> ThumbnailWidget::thumbnailCache;
@@ -26,13 +38,15 @@ ThumbnailWidget::ThumbnailWidget(ImageWidget *imageWidget, QWidget *parent)
     selectedIndex(-1),
     loadedCount(0),
     totalCount(0),
-    futureWatcher(nullptr),
     isLoading(false),
     // ✅ 使用 maxCacheMemoryMB 并转换为字节
     smartThumbnailCache(perfConfig.maxCacheMemoryMB * 1024 * 1024),
     currentBatchIndex(0),
     batchLoadTimer(this),
-    diagnosticTimer(nullptr)
+    resultQueue(std::make_shared<MpscQueue<ThumbnailResult>>()),
+    resultDrainTimer(this),
+    pendingResultCount(0),
+    retryTimer(this)
 {
     setMouseTracking(true);
     setFocusPolicy(Qt::StrongFocus);
@@ -45,10 +59,14 @@ ThumbnailWidget::ThumbnailWidget(ImageWidget *imageWidget, QWidget *parent)
     batchLoadTimer.setInterval(perfConfig.batchLoadDelay);
     connect(&batchLoadTimer, &QTimer::timeout, this, &ThumbnailWidget::processBatchLoad);
 
-    // 诊断定时器 - 每5秒检查一次加载状态
-    diagnosticTimer = new QTimer(this);
-    connect(diagnosticTimer, &QTimer::timeout, this, &ThumbnailWidget::logThumbnailStatus);
-    diagnosticTimer->start(1000);
+    // 结果取出定时器：按显示帧节奏合并重绘
+    resultDrainTimer.setInterval(16);
+    connect(&resultDrainTimer, &QTimer::timeout, this, &ThumbnailWidget::drainThumbnailResults);
+
+    // 失败重试定时器：只在有待重试条目时运行，指向最早的那一个
+    failureClock.start();
+    retryTimer.setSingleShot(true);
+    connect(&retryTimer, &QTimer::timeout, this, &ThumbnailWidget::retryDueThumbnails);
 }
 
 ThumbnailWidget::~ThumbnailWidget()
@@ -59,7 +77,7 @@ ThumbnailWidget::~ThumbnailWidget()
 // 修改 setImageList 方法，加载所有缩略图
 void ThumbnailWidget::setImageList(const QStringList &list, const QDir &dir)
 {
-    qDebug() << "设置缩略图列表，数量:" << list.size();
+    qCDebug(lcThumbnail) << "设置缩略图列表，数量:" << list.size();
 
     // 停止之前的加载
     stopLoading();
@@ -74,23 +92,164 @@ void ThumbnailWidget::setImageList(const QStringList &list, const QDir &dir)
     currentBatchIndex = 0;
     pendingLoadRequests.clear();
     allFilesToLoad.clear();
+    clearFailures();
 
     update();
 
     emit loadingProgress(0, totalCount);
 
-    // 开始加载所有缩略图
-    startLoadingAllThumbnails();
+    // 开始加载所有缩略图；看不见时不和首图解码抢线程池
+    if (isVisible()) {
+        startLoadingAllThumbnails();
+    } else {
+        loadDeferred = true;
+    }
 
     logCacheStats();  // 查看加载后的缓存状态
 }
 
+// 增量插入：只加载新条目的缩略图，不重启整体加载
+void ThumbnailWidget::insertImage(int index, const QString &fileName)
+{
+    index = qBound(0, index, imageList.size());
+    imageList.insert(index, fileName);
+
+    if (selectedIndex >= index) {
+        ++selectedIndex;
+    }
+    totalCount = imageList.size();
+
+    updateMinimumHeight();
+    if (!loadDeferred) {
+        enqueueThumbnailLoad(fileName);
+    }
+    update();
+}
+
+void ThumbnailWidget::removeImage(int index)
+{
+    if (index < 0 || index >= imageList.size()) return;
+
+    QString fileName = imageList.takeAt(index);
+    QString cacheKey = getCacheKey(fileName);
+
+    // 尚未加载的条目从队列中移除，避免加载已删除的文件
+    int pendingPos = allFilesToLoad.indexOf(fileName, currentBatchIndex);
+    if (pendingPos >= 0) {
+        allFilesToLoad.removeAt(pendingPos);
+    }
+
+    if (smartThumbnailCache.remove(cacheKey)) {
+        loadedCount = qMax(0, loadedCount - 1);
+    }
+    {
+        QMutexLocker locker(&cacheMutex);
+        thumbnailCache.remove(cacheKey);
+    }
+    forgetFailure(cacheKey);
+
+    // 保持选中项：删除的是选中项时选中其后一项
+    if (selectedIndex > index) {
+        --selectedIndex;
+    } else if (selectedIndex == index) {
+        selectedIndex = qMin(index, imageList.size() - 1);
+    }
+    totalCount = imageList.size();
+
+    updateMinimumHeight();
+    update();
+}
+
+void ThumbnailWidget::renameImage(int oldIndex, int newIndex, const QString &newFileName)
+{
+    if (oldIndex < 0 || oldIndex >= imageList.size()) return;
+
+    QString oldKey = getCacheKey(imageList.at(oldIndex));
+    bool wasSelected = (selectedIndex == oldIndex);
+
+    imageList.removeAt(oldIndex);
+    if (selectedIndex > oldIndex) {
+        --selectedIndex;
+    }
+
+    // newIndex 是移除旧条目之后的插入位置
+    newIndex = qBound(0, newIndex, imageList.size());
+    imageList.insert(newIndex, newFileName);
+    if (wasSelected) {
+        selectedIndex = newIndex;
+    } else if (selectedIndex >= newIndex) {
+        ++selectedIndex;
+    }
+
+    // 文件内容未变，直接迁移缓存中的缩略图，无需重新解码
+    QString newKey = getCacheKey(newFileName);
+    QPixmap cached = getCachedThumbnail(oldKey);
+    smartThumbnailCache.remove(oldKey);
+    {
+        QMutexLocker locker(&cacheMutex);
+        thumbnailCache.remove(oldKey);
+        if (!cached.isNull()) {
+            thumbnailCache.insert(newKey, cached);
+        }
+    }
+    forgetFailure(oldKey);
+
+    if (!cached.isNull()) {
+        smartThumbnailCache.insert(newKey, new QPixmap(cached), calculateCostForPixmap(cached));
+    } else {
+        enqueueThumbnailLoad(newFileName);
+    }
+
+    update();
+}
+
+// 切换排序方式：条目集合不变，缩略图缓存以文件名为键，无需重新加载
+void ThumbnailWidget::setImageOrder(const QStringList &list)
+{
+    QString selectedName = imageList.value(selectedIndex);
+    imageList = list;
+    selectedIndex = selectedName.isEmpty() ? -1 : imageList.indexOf(selectedName);
+    update();
+}
+
+// 文件内容被修改：只重新生成这一张缩略图
+void ThumbnailWidget::reloadImage(int index)
+{
+    if (index < 0 || index >= imageList.size()) return;
+
+    QString fileName = imageList.at(index);
+    QString cacheKey = getCacheKey(fileName);
+
+    if (smartThumbnailCache.remove(cacheKey)) {
+        loadedCount = qMax(0, loadedCount - 1);
+    }
+    {
+        QMutexLocker locker(&cacheMutex);
+        thumbnailCache.remove(cacheKey);
+    }
+    forgetFailure(cacheKey);
+
+    enqueueThumbnailLoad(fileName);
+    update();
+}
+
+// 追加单个文件到加载队列
+void ThumbnailWidget::enqueueThumbnailLoad(const QString &fileName)
+{
+    allFilesToLoad.append(fileName);
+
+    // 批次定时器未运行说明之前的队列已处理完，立即开始
+    if (!batchLoadTimer.isActive()) {
+        processBatchLoad();
+    }
+}
+
 // 开始加载所有缩略图
 void ThumbnailWidget::startLoadingAllThumbnails()
 {
     if (imageList.isEmpty()) return;
 
-    qDebug() << "开始加载所有缩略图，总数:" << imageList.size();
+    qCDebug(lcThumbnail) << "开始加载所有缩略图，总数:" << imageList.size();
 
     // 准备所有需要加载的文件
     allFilesToLoad = imageList;
@@ -112,6 +271,10 @@ void ThumbnailWidget::processBatchLoad()
 
     int startIndex = currentBatchIndex;
     int endIndex = qMin(currentBatchIndex + perfConfig.batchLoadSize, allFilesToLoad.size());
+    // 压缩包条目一次全部提交：整个压缩包只遍历解压一遍，不按批次反复从头扫描
+    if (allFilesToLoad.at(startIndex).contains("|")) {
+        endIndex = allFilesToLoad.size();
+    }
 
     QStringList batchFiles;
     for (int i = startIndex; i < endIndex; ++i) {
@@ -124,288 +287,322 @@ void ThumbnailWidget::processBatchLoad()
     // 安排下一批次（如果未完成）
     if (currentBatchIndex < allFilesToLoad.size()) {
         batchLoadTimer.start();
-    } else {
-        // 注意：这里不能直接设 isLoading = false，因为批次是异步的
-        // 需要在所有异步加载完成的回调中处理
+    } else if (pendingResultCount == 0) {
+        // 最后一批全部命中缓存，没有异步任务需要等待
+        finishLoading();
     }
+    // 否则在 drainThumbnailResults 取完所有结果后完成
 }
 // 批量加载缩略图
-void ThumbnailWidget::loadThumbnailsBatch(const QStringList &fileNames)
+void ThumbnailWidget::loadThumbnailsBatch(const QStringList &fileNames, int priority)
 {
     if (fileNames.isEmpty()) return;
 
-    // 在工作线程中只做文件 I/O 和解码
-    QtConcurrent::run([this, fileNames]() {
-        QList<QPair<QString, QPixmap>> loadedResults;
+    const bool urgent = priority >= ThreadPools::PriorityVisible;
+    int submitted = 0;
+    // 压缩包条目按压缩包分组，每组一次遍历解压
+    QMap<QString, QVector<ThumbnailJob>> archiveJobs;
 
-        for (const QString &fileName : fileNames) {
-            QString cacheKey = getCacheKey(fileName);
+    for (int i = 0; i < fileNames.size(); ++i) {
+        const QString &fileName = fileNames.at(i);
+        QString cacheKey = getCacheKey(fileName);
 
-            // 线程安全：只检查只读的静态缓存？不行，静态缓存也可能被主线程修改
-            // 因此工作线程完全不触碰任何缓存，只负责加载原始图片
-            QPixmap pixmap = loadSingleThumbnail(fileName);
-            if (!pixmap.isNull()) {
-                loadedResults.append(qMakePair(fileName, pixmap));
+        // 已在加载中：只有以更高优先级重新请求（变为可见）时才再提交一次，先到的结果生效
+        if (pendingLoadRequests.contains(fileName)) {
+            if (!urgent) {
+                // 后台批次轮到了正在按可见优先级加载的文件，结果到达时计入进度
+                uncountedLoadRequests.remove(fileName);
+                continue;
             }
+            if (urgentLoadRequests.contains(fileName)) continue;
         }
 
-        // 将结果传回主线程
-        if (!loadedResults.isEmpty()) {
-            QMetaObject::invokeMethod(this, [this, loadedResults]() {
-                // 主线程安全地更新缓存
-                for (const auto &pair : loadedResults) {
-                    QString cacheKey = getCacheKey(pair.first);
-                    QPixmap thumbnail = pair.second;
-
-                    int cost = calculateCostForPixmap(thumbnail);
-                    smartThumbnailCache.insert(cacheKey, new QPixmap(thumbnail), cost);
-                    {
-                        QMutexLocker locker(&cacheMutex);
-                        thumbnailCache.insert(cacheKey, thumbnail);
-                    }
-                    loadedCount++;
-                }
+        // 缓存检查和顶层压缩包图标都在 GUI 线程完成，工作线程不触碰任何缓存
+        // 加载进度只按后台批次计数，可见优先级的请求等后台批次轮到时再计入
+        if (!getCachedThumbnail(cacheKey).isNull()) {
+            Metrics::cacheHit(Metrics::MemoryTier);
+            if (!urgent) loadedCount++;
+            continue;
+        }
+        Metrics::cacheMiss(Metrics::MemoryTier);
+        if (!fileName.contains("|") && isArchiveFile(fileName)) {
+            QPixmap icon = createArchiveIcon();
+            smartThumbnailCache.insert(cacheKey, new QPixmap(icon), calculateCostForPixmap(icon));
+            {
+                QMutexLocker locker(&cacheMutex);
+                thumbnailCache.insert(cacheKey, icon);
+            }
+            if (!urgent) loadedCount++;
+            continue;
+        }
 
-                emit loadingProgress(loadedCount, totalCount);
-                update(visibleRegion().boundingRect());
+        // 记录提交时的位置，结果到达时用来快速定位重绘区域
+        ThumbnailJob job;
+        job.fileName = fileName;
+        job.path = cacheKey;
+        job.indexHint = currentBatchIndex + i;
+        if (imageList.value(job.indexHint) != fileName) {
+            job.indexHint = imageList.indexOf(fileName);
+        }
 
-                // 检查是否所有批次都已完成
-                if (currentBatchIndex >= allFilesToLoad.size() && loadedCount >= totalCount) {
-                    finishLoading();
-                }
-            }, Qt::QueuedConnection);
+        if (urgent) {
+            if (!pendingLoadRequests.contains(fileName)) uncountedLoadRequests.insert(fileName);
+            urgentLoadRequests.insert(fileName);
+        }
+        pendingLoadRequests.insert(fileName);
+        const int separator = job.path.indexOf('|');
+        if (separator >= 0) {
+            archiveJobs[job.path.left(separator)].append(job);
         } else {
-            // 即使没有加载成功，也要更新计数并检查完成状态
-            QMetaObject::invokeMethod(this, [this]() {
-                // 这里实际上 loadedCount 没变，但我们可以通过批次索引判断
-                if (currentBatchIndex >= allFilesToLoad.size() && loadedCount >= totalCount) {
-                    finishLoading();
-                }
-            }, Qt::QueuedConnection);
+            submitThumbnailJob(job, priority);
         }
-    });
-}
+        ++submitted;
+    }
 
-// 新增完成处理函数
-void ThumbnailWidget::finishLoading()
-{
-    isLoading = false;
-    qDebug() << "所有缩略图批次加载完成";
-    emit loadingProgress(loadedCount, totalCount);
-    update();
+    for (auto it = archiveJobs.cbegin(); it != archiveJobs.cend(); ++it) {
+        submitArchiveJobs(it.key(), it.value(), priority);
+    }
+
+    if (submitted > 0) {
+        startResultDrain(submitted);
+    }
 }
 
-// 加载单个缩略图
-QPixmap ThumbnailWidget::loadSingleThumbnail(const QString &fileName)
+void ThumbnailWidget::submitThumbnailJob(const ThumbnailJob &job, int priority, bool idle)
 {
-    QString cacheKey = getCacheKey(fileName);
-
-    //qDebug() << "加载缩略图:" << fileName << "缓存键:" << cacheKey;
-
-    // ---------- 新增：顶层压缩包直接返回图标 ----------
-    if (isArchiveFile(fileName) && !fileName.contains("|")) {
-        QPixmap icon = createArchiveIcon();
-        // 存入缓存，避免后续重复生成
-        {
-            QMutexLocker locker(&cacheMutex);
-            thumbnailCache.insert(cacheKey, icon);
-        }
-        int cost = calculateCostForPixmap(icon);
-        smartThumbnailCache.insert(cacheKey, new QPixmap(icon), cost);
-        return icon;
+    // 任务只持有队列、令牌和参数，不捕获 this，也不读取 imageList
+    const CancellationToken token = loadGeneration.token();
+    const std::shared_ptr<MpscQueue<ThumbnailResult>> queue = resultQueue;
+    const QSize size = thumbnailSize;
+
+    auto makeResult = [job, token]() {
+        ThumbnailResult result;
+        result.fileName = job.fileName;
+        result.indexHint = job.indexHint;
+        result.generation = token.generation();
+        return result;
+    };
+
+    if (idle) {
+        ThreadPools::idle()->start([queue, token, size, job, makeResult]() {
+            ThumbnailResult result = makeResult();
+            result.load = ThumbnailLoader::loadThumbnail(job.path, size, token);
+            queue->push(std::move(result));
+        }, priority);
+        return;
     }
 
-    // 快速缓存检查
-    if (QPixmap* cached = smartThumbnailCache.object(cacheKey)) {
-        if (!cached->isNull()) {
-            qDebug() << "从智能缓存获取:" << fileName;
-            return *cached;
-        } else {
-            qDebug() << "智能缓存中的缩略图为空，重新加载:" << fileName;
-            smartThumbnailCache.remove(cacheKey);
+    // 阶段 1（I/O 池）：先查磁盘缓存，未命中再读文件或解压；慢速磁盘只占用 I/O 线程
+    ThreadPools::io()->start([queue, token, size, job, priority, makeResult]() {
+        ThumbnailResult result = makeResult();
+        if (token.isCancelled()) {
+            result.load.cancelled = true;
+            queue->push(std::move(result));
+            return;
+        }
+        result.load.image = ThumbnailDiskCache::load(job.path, size);
+        if (!result.load.image.isNull()) {
+            queue->push(std::move(result));
+            return;
         }
-    }
 
-    // 回退到静态缓存检查
-    {
-        QMutexLocker locker(&cacheMutex);
-        if (thumbnailCache.contains(cacheKey)) {
-            QPixmap cached = thumbnailCache.value(cacheKey);
-            if (!cached.isNull()) {
-                qDebug() << "从静态缓存获取:" << fileName;
-                return cached;
-            } else {
-                qDebug() << "静态缓存中的缩略图为空，移除:" << fileName;
-                thumbnailCache.remove(cacheKey);
-            }
+        QByteArray data = ThumbnailLoader::readSource(job.path, token, &result.load.error);
+        if (token.isCancelled() || data.isEmpty()) {
+            // 取消或失败也入队一个结果，让 GUI 端的计数保持一致
+            result.load.cancelled = token.isCancelled();
+            queue->push(std::move(result));
+            return;
         }
-    }
 
-    QPixmap result;
+        decodeOnCpuPool(queue, token, size, job.path, data, priority, std::move(result));
+    }, priority);
+}
 
-    try {
-        // 压缩包文件处理
-        if (fileName.contains("|")) {
-            qDebug() << "处理压缩包文件:" << fileName;
+// 阶段 2（CPU 池）：解码并缩放，保持同样的优先级
+void ThumbnailWidget::decodeOnCpuPool(const std::shared_ptr<MpscQueue<ThumbnailResult>> &queue,
+                                      const CancellationToken &token, const QSize &size,
+                                      const QString &path, const QByteArray &data, int priority,
+                                      ThumbnailResult result, const std::shared_ptr<void> &hold)
+{
+    ThreadPools::cpu()->start([queue, token, size, path, data, hold, result = std::move(result)]() mutable {
+        result.load.image = ThumbnailLoader::decodeThumbnail(data, path, size, token, &result.load.error);
+        ThumbnailDiskCache::store(path, size, result.load.image);
+        result.load.cancelled = token.isCancelled();
+        queue->push(std::move(result));
+    }, priority);
+}
 
-            if (imageWidget) {
-                result = imageWidget->getArchiveThumbnail(fileName);
-                if (!result.isNull()) {
-                    qDebug() << "成功获取压缩包缩略图:" << fileName << "尺寸:" << result.size();
-                } else {
-                    qDebug() << "压缩包缩略图获取失败:" << fileName;
-                    result = createArchiveIcon();
-                    failedThumbnails.insert(cacheKey);
-                    loadingErrors.insert(cacheKey, "压缩包缩略图获取失败");
+// 同一压缩包里的多个条目：在 I/O 池打开一次、按压缩包内顺序遍历一遍，
+// 解压出一个就交给 CPU 池解码，代替每个条目各自从头扫描压缩包
+void ThumbnailWidget::submitArchiveJobs(const QString &archivePath, const QVector<ThumbnailJob> &jobs, int priority)
+{
+    const CancellationToken token = loadGeneration.token();
+    const std::shared_ptr<MpscQueue<ThumbnailResult>> queue = resultQueue;
+    const QSize size = thumbnailSize;
+    // 已解压、尚未解码完的条目数上限，大压缩包不会整个读进内存
+    const int capacity = ThreadPools::cpu()->maxThreadCount() * 2;
+
+    ThreadPools::io()->start([queue, token, size, archivePath, jobs, priority, capacity]() {
+        auto makeResult = [&token](const ThumbnailJob &job) {
+            ThumbnailResult result;
+            result.fileName = job.fileName;
+            result.indexHint = job.indexHint;
+            result.generation = token.generation();
+            return result;
+        };
+
+        // 先查磁盘缓存，剩下的按内部路径记下来
+        QHash<QString, ThumbnailJob> remaining;
+        for (const ThumbnailJob &job : jobs) {
+            if (!token.isCancelled()) {
+                ThumbnailResult result = makeResult(job);
+                result.load.image = ThumbnailDiskCache::load(job.path, size);
+                if (!result.load.image.isNull()) {
+                    queue->push(std::move(result));
+                    continue;
                 }
-            } else {
-                qDebug() << "没有有效的imageWidget，使用默认图标:" << fileName;
-                result = createArchiveIcon();
             }
-        } else {
-            // 普通文件 - 使用高效加载
-            QString fullPath = currentDir.absoluteFilePath(fileName);
-            //qDebug() << "加载普通文件:" << fullPath;
-
-            if (QFile::exists(fullPath)) {
-                result = loadImageFileFast(fullPath);
-
-                if (result.isNull()) {
-                    qDebug() << "普通文件加载失败:" << fileName;
-                    result = createArchiveIcon(); // 使用压缩包图标作为通用错误图标
-                    failedThumbnails.insert(cacheKey);
-                    loadingErrors.insert(cacheKey, "图片文件加载失败");
-                }
+            remaining.insert(job.path.mid(archivePath.size() + 1), job);
+        }
+
+        QString error = "压缩包缩略图获取失败";
+        ArchiveHandler handler;
+        if (!remaining.isEmpty() && !token.isCancelled()) {
+            if (!handler.openArchive(archivePath)) {
+                error = "压缩包打开失败";
             } else {
-                qDebug() << "文件不存在:" << fullPath;
-                result = createArchiveIcon();
-                failedThumbnails.insert(cacheKey);
-                loadingErrors.insert(cacheKey, "文件不存在");
+                const auto inFlight = std::make_shared<QSemaphore>(capacity);
+                handler.forEachImage(
+                    [&remaining](const QString &name) { return remaining.contains(name); },
+                    [&](const QString &name, const QByteArray &data) {
+                        while (!inFlight->tryAcquire(1, 100)) {
+                            if (token.isCancelled()) return false;
+                        }
+                        // 解码任务执行完或被线程池丢弃时析构，归还名额
+                        const std::shared_ptr<void> slot(nullptr, [inFlight](void *) { inFlight->release(); });
+                        const ThumbnailJob job = remaining.take(name);
+                        decodeOnCpuPool(queue, token, size, job.path, data, priority, makeResult(job), slot);
+                        return !remaining.isEmpty() && !token.isCancelled();
+                    });
             }
         }
-    } catch (const std::exception& e) {
-        qDebug() << "加载缩略图时发生异常:" << e.what() << "文件:" << fileName;
-        result = createArchiveIcon();
-        failedThumbnails.insert(cacheKey);
-        loadingErrors.insert(cacheKey, QString("异常: %1").arg(e.what()));
-    } catch (...) {
-        qDebug() << "加载缩略图时发生未知异常，文件:" << fileName;
-        result = createArchiveIcon();
-        failedThumbnails.insert(cacheKey);
-        loadingErrors.insert(cacheKey, "未知异常");
-    }
-
-    // 确保结果有效
-    if (result.isNull()) {
-        qDebug() << "最终结果为空，使用默认图标:" << fileName;
-        result = createArchiveIcon();
-    }
 
-    return result;
+        // 取消、打开失败或压缩包里找不到的条目也要入队一个结果，让 GUI 端的计数保持一致
+        for (const ThumbnailJob &job : std::as_const(remaining)) {
+            ThumbnailResult result = makeResult(job);
+            result.load.error = error;
+            result.load.cancelled = token.isCancelled();
+            queue->push(std::move(result));
+        }
+    }, priority);
 }
 
-// 高效图片加载
-QPixmap ThumbnailWidget::loadImageFileFast(const QString &filePath)
+void ThumbnailWidget::startResultDrain(int submittedCount)
 {
-    // 检查文件是否存在和可读
-    QFileInfo fileInfo(filePath);
-    if (!fileInfo.exists()) {
-        qDebug() << "文件不存在:" << filePath;
-        return QPixmap();
-    }
-
-    if (!fileInfo.isReadable()) {
-        qDebug() << "文件不可读:" << filePath;
-        return QPixmap();
+    pendingResultCount += submittedCount;
+    Metrics::addQueuedDecodes(submittedCount);
+    if (!resultDrainTimer.isActive()) {
+        resultDrainTimer.start();
     }
+}
 
-    if (fileInfo.size() == 0) {
-        qDebug() << "文件大小为0:" << filePath;
-        return QPixmap();
-    }
-
-    // 方法1: 使用 QImageReader（最可靠）
-    QImageReader reader(filePath);
-
-    // 检查格式支持
-    if (!reader.canRead()) {
-        qDebug() << "QImageReader 不支持此格式:" << filePath << "格式:" << reader.format();
-        // 继续尝试其他方法
-    } else {
-        // 设置优化参数
-        reader.setAutoTransform(true);
-        reader.setQuality(50);
+// GUI 线程：取出这段时间内到达的所有结果，合并成一次重绘
+void ThumbnailWidget::drainThumbnailResults()
+{
+    PV_TRACE_SCOPE_CAT("drainResults", "paint");
+    const QRect visibleRect = visibleRegion().boundingRect();
+    QRegion dirty;
+    int arrived = 0;
+
+    const quint64 generation = loadGeneration.current();
+
+    ThumbnailResult result;
+    while (resultQueue->tryPop(result)) {
+        --pendingResultCount;
+        // 旧目录的结果直接丢弃
+        if (result.load.cancelled || result.generation != generation) {
+            Metrics::addQueuedDecodes(-1);
+            continue;
+        }
+        // 同一文件以不同优先级提交过两次时，只处理先到的那个
+        if (!pendingLoadRequests.remove(result.fileName)) {
+            Metrics::addQueuedDecodes(-1);
+            continue;
+        }
+        Metrics::decodeFinished(!result.load.image.isNull());
+        urgentLoadRequests.remove(result.fileName);
+        const bool counted = !uncountedLoadRequests.remove(result.fileName);
+        ++arrived;
+
+        QString cacheKey = getCacheKey(result.fileName);
+        QPixmap thumbnail;
+        if (result.load.image.isNull()) {
+            qCDebug(lcThumbnail) << "缩略图加载失败:" << result.fileName << result.load.error;
+            thumbnail = createArchiveIcon(); // 使用压缩包图标作为通用错误图标
+            recordFailure(cacheKey, result.fileName, result.load.error);
+        } else {
+            forgetFailure(cacheKey);
+            // QPixmap 只在 GUI 线程创建
+            thumbnail = QPixmap::fromImage(std::move(result.load.image));
+        }
 
-        QImage image;
-        if (reader.read(&image)) {
-            //qDebug() << "QImageReader 加载成功:" << filePath << "原始尺寸:" << image.size();
+        int cost = calculateCostForPixmap(thumbnail);
+        smartThumbnailCache.insert(cacheKey, new QPixmap(thumbnail), cost);
+        {
+            QMutexLocker locker(&cacheMutex);
+            thumbnailCache.insert(cacheKey, thumbnail);
+        }
+        if (counted) loadedCount++;
 
-            if (image.isNull()) {
-                qDebug() << "QImageReader 读取的图像为空:" << filePath;
-            } else {
-                // 保持宽高比进行缩放
-                QImage scaled = scaleImageWithAspectRatio(image);
-                return QPixmap::fromImage(scaled);
+        // 提交后列表可能变化（增删/重排），位置不符时重新查找
+        int index = result.indexHint;
+        if (imageList.value(index) != result.fileName) {
+            index = imageList.indexOf(result.fileName);
+        }
+        if (index >= 0) {
+            QRect rect = itemRect(index);
+            if (rect.intersects(visibleRect)) {
+                dirty += rect;
             }
-        } else {
-            qDebug() << "QImageReader 加载失败:" << filePath << "错误:" << reader.errorString();
         }
     }
 
-    // 方法2: 直接使用 QImage（备用方法）
-    QImage image2;
-    if (image2.load(filePath)) {
-        qDebug() << "QImage 直接加载成功:" << filePath << "原始尺寸:" << image2.size();
-
-        if (image2.isNull()) {
-            qDebug() << "QImage 读取的图像为空:" << filePath;
-        } else {
-            // 保持宽高比进行缩放
-            QImage scaled = scaleImageWithAspectRatio(image2);
-            return QPixmap::fromImage(scaled);
+    if (arrived > 0) {
+        Metrics::setCacheBytes(Metrics::MemoryTier, smartThumbnailCache.totalCost());
+        emit loadingProgress(loadedCount, totalCount);
+        if (isLoading) {
+            // 左上角的加载进度文字
+            dirty += QRect(0, 0, 300, 30).intersected(visibleRect);
+        }
+        if (!dirty.isEmpty()) {
+            update(dirty);
         }
-    } else {
-        qDebug() << "QImage 直接加载也失败:" << filePath;
     }
 
-    // 方法3: 尝试使用 QPixmap（最后的手段）
-    QPixmap pixmap;
-    if (pixmap.load(filePath)) {
-        qDebug() << "QPixmap 加载成功:" << filePath << "原始尺寸:" << pixmap.size();
-
-        if (pixmap.isNull()) {
-            qDebug() << "QPixmap 读取的图像为空:" << filePath;
-        } else {
-            // 保持宽高比进行缩放
-            return scaleThumbnailWithAspectRatio(pixmap);
+    if (pendingResultCount <= 0) {
+        pendingResultCount = 0;
+        resultDrainTimer.stop();
+        // 检查是否所有批次都已完成
+        if (currentBatchIndex >= allFilesToLoad.size()) {
+            finishLoading();
         }
-    } else {
-        qDebug() << "所有加载方法都失败:" << filePath;
     }
-
-    return QPixmap();
 }
 
-// 保持宽高比缩放
-QPixmap ThumbnailWidget::scaleThumbnailWithAspectRatio(const QPixmap &original) const
-{
-    if (original.isNull()) return QPixmap();
-
-    // 保持宽高比进行缩放
-    return original.scaled(thumbnailSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-}
-
-QImage ThumbnailWidget::scaleImageWithAspectRatio(const QImage &original) const
+// 新增完成处理函数
+void ThumbnailWidget::finishLoading()
 {
-    if (original.isNull()) return QImage();
-
-    // 保持宽高比进行缩放
-    return original.scaled(thumbnailSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    isLoading = false;
+    qCDebug(lcThumbnail) << "所有缩略图批次加载完成";
+    emit loadingProgress(loadedCount, totalCount);
+    update();
 }
 
 // 绘制方法
 void ThumbnailWidget::paintEvent(QPaintEvent *event)
 {
+    PV_TRACE_SCOPE_CAT("thumbnailPaint", "paint");
+    Metrics::FrameScope frameScope;
     QPainter painter(this);
     painter.fillRect(rect(), QColor(25, 25, 25)); // 深色背景更好看
 
@@ -428,6 +625,7 @@ void ThumbnailWidget::paintEvent(QPaintEvent *event)
     painter.setClipRect(event->rect());
 
     int itemsPerRow = calculateItemsPerRow();
+    QStringList visibleMissing;   // 正在显示但还没有缩略图的文件
 
     // 绘制所有缩略图
     for (int i = 0; i < imageList.size(); ++i) {
@@ -447,13 +645,16 @@ void ThumbnailWidget::paintEvent(QPaintEvent *event)
         }
 
         QString cacheKey = getCacheKey(fileName);
-        bool isTopLevelArchive = isArchiveFile(fileName) && !fileName.contains("|");
+        bool isTopLevelArchive = !fileName.contains("|") && isArchiveFile(fileName);
 
         // 获取缩略图（智能缓存优先）
         QPixmap thumbnail = getCachedThumbnail(cacheKey);
         if (thumbnail.isNull() && isTopLevelArchive) {
             thumbnail = createArchiveIcon();
         }
+        if (thumbnail.isNull() && !urgentLoadRequests.contains(fileName)) {
+            visibleMissing.append(fileName);
+        }
 
         drawThumbnailItem(painter, i, currentX, currentY, fileName, thumbnail, isTopLevelArchive);
     }
@@ -464,6 +665,15 @@ void ThumbnailWidget::paintEvent(QPaintEvent *event)
         painter.drawText(10, 20, QString("Loading: %1/%2").arg(loadedCount).arg(totalCount));
     }
 
+    // 可见项以最高优先级插队，不必等后台批次按顺序轮到（绘制结束后再提交）
+    if (!visibleMissing.isEmpty()) {
+        const quint64 generation = loadGeneration.current();
+        QTimer::singleShot(0, this, [this, visibleMissing, generation]() {
+            if (loadGeneration.current() != generation) return;
+            loadThumbnailsBatch(visibleMissing, ThreadPools::PriorityVisible);
+        });
+    }
+
     updateMinimumHeight();
 }
 
@@ -551,6 +761,18 @@ int ThumbnailWidget::calculateItemsPerRow() const
                        (thumbnailSize.width() + thumbnailSpacing));
 }
 
+// 单个缩略图（含文件名）的区域，与 paintEvent 中的布局一致
+QRect ThumbnailWidget::itemRect(int index) const
+{
+    int itemsPerRow = calculateItemsPerRow();
+    int row = index / itemsPerRow;
+    int col = index % itemsPerRow;
+    int x = thumbnailSpacing + col * (thumbnailSize.width() + thumbnailSpacing);
+    int y = thumbnailSpacing + row * (thumbnailSize.height() + thumbnailSpacing + 25);
+    // 选中框向外扩 3 像素
+    return QRect(x, y, thumbnailSize.width(), thumbnailSize.height() + 25).adjusted(-3, -3, 3, 3);
+}
+
 // 压缩包图标
 QPixmap ThumbnailWidget::createArchiveIcon() const
 {
@@ -578,23 +800,25 @@ QPixmap ThumbnailWidget::createArchiveIcon() const
 // 停止加载
 void ThumbnailWidget::stopLoading()
 {
+    loadDeferred = false;
     batchLoadTimer.stop();
-    if (futureWatcher && futureWatcher->isRunning()) {
-        futureWatcher->cancel();
-        futureWatcher->waitForFinished();
-    }
+    pendingLoadRequests.clear();
+    urgentLoadRequests.clear();
+    uncountedLoadRequests.clear();
+    // 使已提交的任务全部失效：它们在下一个阶段检查时退出，线程池立即可用于新目录
+    loadGeneration.advance();
     isLoading = false;
 }
 
 // 诊断方法
 void ThumbnailWidget::diagnoseLoadingIssues()
 {
-    qDebug() << "=== 缩略图加载问题诊断 ===";
-    qDebug() << "总图片数量:" << imageList.size();
-    qDebug() << "智能缓存数量:" << smartThumbnailCache.size();
-    qDebug() << "静态缓存数量:" << thumbnailCache.size();
-    qDebug() << "已加载数量:" << loadedCount;
-    qDebug() << "失败缩略图:" << failedThumbnails.size();
+    qCDebug(lcThumbnail) << "=== 缩略图加载问题诊断 ===";
+    qCDebug(lcThumbnail) << "总图片数量:" << imageList.size();
+    qCDebug(lcThumbnail) << "智能缓存数量:" << smartThumbnailCache.size();
+    qCDebug(lcThumbnail) << "静态缓存数量:" << thumbnailCache.size();
+    qCDebug(lcThumbnail) << "已加载数量:" << loadedCount;
+    qCDebug(lcThumbnail) << "失败缩略图:" << failures.size() << "待重试:" << retrySchedule.size();
 
     // 检查每个文件的状态
     for (int i = 0; i < imageList.size(); ++i) {
@@ -603,113 +827,141 @@ void ThumbnailWidget::diagnoseLoadingIssues()
 
         bool inSmartCache = smartThumbnailCache.contains(cacheKey);
         bool inStaticCache = thumbnailCache.contains(cacheKey);
-        bool isFailed = failedThumbnails.contains(cacheKey);
+        bool isFailed = failures.contains(cacheKey);
 
         if (!inSmartCache && !inStaticCache && !isFailed) {
-            qDebug() << "未加载的文件:" << fileName;
-            qDebug() << "  - 索引:" << i;
-            qDebug() << "  - 缓存键:" << cacheKey;
-            qDebug() << "  - 是否压缩包:" << (fileName.contains("|") || isArchiveFile(fileName));
+            qCDebug(lcThumbnail) << "未加载的文件:" << fileName;
+            qCDebug(lcThumbnail) << "  - 索引:" << i;
+            qCDebug(lcThumbnail) << "  - 缓存键:" << cacheKey;
+            qCDebug(lcThumbnail) << "  - 是否压缩包:" << (fileName.contains("|") || isArchiveFile(fileName));
         }
     }
 
-    qDebug() << "=== 诊断结束 ===";
+    qCDebug(lcThumbnail) << "=== 诊断结束 ===";
 }
 
-void ThumbnailWidget::logThumbnailStatus()
+void ThumbnailWidget::recordFailure(const QString &cacheKey, const QString &fileName, const QString &error)
 {
-    if (imageList.isEmpty()) return;
+    FailureState &state = failures[cacheKey];
+    if (state.retryAtMs >= 0) {
+        retrySchedule.remove(state.retryAtMs, cacheKey);
+    }
+    state.fileName = fileName;
+    state.error = error;
+    ++state.attempts;
 
-    int loaded = 0;
-    int failed = failedThumbnails.size();
-    int total = imageList.size();
+    if (state.attempts >= kMaxLoadAttempts) {
+        state.retryAtMs = -1;
+        qCDebug(lcThumbnail) << "缩略图重试次数用完:" << fileName << error;
+        return;
+    }
 
-    for (int i = 0; i < imageList.size(); ++i) {
-        QString fileName = imageList.at(i);
-        QString cacheKey = getCacheKey(fileName);
+    // 2s、8s……
+    const qint64 delay = qint64(kRetryBaseDelayMs) << (2 * (state.attempts - 1));
+    state.retryAtMs = failureClock.elapsed() + delay;
+    retrySchedule.insert(state.retryAtMs, cacheKey);
+    scheduleRetryTimer();
+}
 
-        if (smartThumbnailCache.contains(cacheKey) || thumbnailCache.contains(cacheKey)) {
-            loaded++;
-        }
+void ThumbnailWidget::forgetFailure(const QString &cacheKey)
+{
+    auto it = failures.find(cacheKey);
+    if (it == failures.end()) return;
+    if (it->retryAtMs >= 0) {
+        retrySchedule.remove(it->retryAtMs, cacheKey);
     }
+    failures.erase(it);
+}
 
-    qDebug() << "缩略图状态 - 已加载:" << loaded << "/" << total
-             << "失败:" << failed;
+void ThumbnailWidget::clearFailures()
+{
+    failures.clear();
+    retrySchedule.clear();
+    retryTimer.stop();
+}
 
-    // 如果有很多失败的，尝试重新加载
-    if (failed > total * 0.3) { // 超过30%失败
-        qDebug() << "检测到大量失败，尝试重新加载...";
-        forceReloadAll();
+void ThumbnailWidget::scheduleRetryTimer()
+{
+    if (retrySchedule.isEmpty()) {
+        retryTimer.stop();
+        return;
     }
+    const qint64 wait = qMax<qint64>(0, retrySchedule.firstKey() - failureClock.elapsed());
+    retryTimer.start(int(qMin<qint64>(wait, std::numeric_limits<int>::max())));
 }
 
-void ThumbnailWidget::forceReloadAll()
+// 到期的条目逐个重新提交，其余的等下一次定时器
+void ThumbnailWidget::retryDueThumbnails()
 {
-    qDebug() << "强制重新加载所有缩略图";
+    const qint64 now = failureClock.elapsed();
+    int retryCount = 0;
+    while (!retrySchedule.isEmpty() && retrySchedule.firstKey() <= now) {
+        const QString cacheKey = retrySchedule.first();
+        retrySchedule.erase(retrySchedule.begin());
+
+        auto it = failures.find(cacheKey);
+        if (it == failures.end()) continue;
+        it->retryAtMs = -1;
+        const QString fileName = it->fileName;
+        if (pendingLoadRequests.contains(fileName)) continue;
+
+        resubmitFailed(cacheKey, fileName);
+        ++retryCount;
+    }
 
-    // 停止所有正在进行的加载
-    stopLoading();
+    if (retryCount > 0) {
+        qCDebug(lcThumbnail) << "重试失败的缩略图:" << retryCount;
+        startResultDrain(retryCount);
+        update();
+    }
+    scheduleRetryTimer();
+}
 
-    // 清空所有缓存和状态
-    smartThumbnailCache.clear();
+// 移除失败占位图，放到空闲池重新加载；重试再多也不会挤占可见缩略图和预加载
+void ThumbnailWidget::resubmitFailed(const QString &cacheKey, const QString &fileName)
+{
+    if (smartThumbnailCache.remove(cacheKey)) {
+        loadedCount = qMax(0, loadedCount - 1);
+    }
     {
         QMutexLocker locker(&cacheMutex);
-        thumbnailCache.clear();
+        thumbnailCache.remove(cacheKey);
     }
-
-    pendingLoadRequests.clear();
-    failedThumbnails.clear();
-    loadingErrors.clear();
-    currentBatchIndex = 0;
-
-    // 重新开始加载
-    startLoadingAllThumbnails();
-    update();
+    FormatSniffer::invalidate(cacheKey);
+
+    ThumbnailJob job;
+    job.fileName = fileName;
+    job.path = cacheKey;
+    job.indexHint = imageList.indexOf(fileName);
+    pendingLoadRequests.insert(fileName);
+    submitThumbnailJob(job, ThreadPools::PriorityBackground, true);
 }
 
 void ThumbnailWidget::retryFailedThumbnails()
 {
-    qDebug() << "重试失败的缩略图，数量:" << failedThumbnails.size();
-
-    // 将失败的缩略图重新加入加载队列
-    for (const QString &cacheKey : failedThumbnails) {
-        // 从缓存键解析文件名
-        QString fileName;
-        if (cacheKey.contains("|")) {
-            fileName = cacheKey;
-        } else {
-            QFileInfo fileInfo(cacheKey);
-            fileName = fileInfo.fileName();
-        }
-
-        // 重新加载这个文件
-        QtConcurrent::run([this, fileName]() {
-            QPixmap thumbnail = loadSingleThumbnail(fileName);
-
-            QMetaObject::invokeMethod(this, [this, fileName, thumbnail]() {
-                QString cacheKey = getCacheKey(fileName);
-                if (!thumbnail.isNull()) {
-                    smartThumbnailCache.insert(cacheKey, new QPixmap(thumbnail));
-                    QMutexLocker locker(&cacheMutex);
-                    thumbnailCache.insert(cacheKey, thumbnail);
-                    failedThumbnails.remove(cacheKey);
-                    loadingErrors.remove(cacheKey);
-                    loadedCount++;
-                    update();
-                }
-            }, Qt::QueuedConnection);
-        });
+    qCDebug(lcThumbnail) << "重试失败的缩略图，数量:" << failures.size();
+
+    // 手动重试给每个条目新的预算
+    retrySchedule.clear();
+    int retryCount = 0;
+    for (auto it = failures.begin(); it != failures.end(); ++it) {
+        it->attempts = 0;
+        it->retryAtMs = -1;
+        if (pendingLoadRequests.contains(it->fileName)) continue;
+        resubmitFailed(it.key(), it->fileName);
+        ++retryCount;
     }
+    scheduleRetryTimer();
 
+    if (retryCount > 0) {
+        startResultDrain(retryCount);
+    }
     update();
 }
 
 bool ThumbnailWidget::isArchiveFile(const QString &fileName) const
 {
-    QString lowerName = fileName.toLower();
-    return (lowerName.endsWith(".zip") || lowerName.endsWith(".rar") ||
-            lowerName.endsWith(".7z") || lowerName.endsWith(".tar") ||
-            lowerName.endsWith(".gz") || lowerName.endsWith(".bz2"));
+    return FormatSniffer::isArchiveFile(currentDir.absoluteFilePath(fileName));
 }
 
 // 其他现有方法保持不变...
@@ -719,7 +971,7 @@ void ThumbnailWidget::setSelectedIndex(int index)
         selectedIndex = index;
         update();
         ensureVisible(index);
-        qDebug() << "ThumbnailWidget 选中索引:" << index;
+        qCDebug(lcThumbnail) << "ThumbnailWidget 选中索引:" << index;
     }
 }
 
@@ -756,6 +1008,7 @@ void ThumbnailWidget::clearThumbnailCache()
 
 void ThumbnailWidget::clearThumbnailCacheForImage(const QString &imagePath)
 {
+    FormatSniffer::invalidate(imagePath);
     QMutexLocker locker(&cacheMutex);
     thumbnailCache.remove(imagePath);
 }
@@ -815,7 +1068,7 @@ void ThumbnailWidget::selectThumbnailAtPosition(const QPoint &pos)
 
 void ThumbnailWidget::keyPressEvent(QKeyEvent *event)
 {
-    qDebug() << "ThumbnailWidget 接收到按键:" << event->key();
+    qCDebug(lcThumbnail) << "ThumbnailWidget 接收到按键:" << event->key();
 
     if (imageList.isEmpty()) {
         QWidget::keyPressEvent(event);
@@ -845,7 +1098,7 @@ void ThumbnailWidget::keyPressEvent(QKeyEvent *event)
     break;
     case Qt::Key_Enter:
     case Qt::Key_Return:
-        qDebug() << "处理回车键，选中索引:" << selectedIndex;
+        qCDebug(lcThumbnail) << "处理回车键，选中索引:" << selectedIndex;
         if (selectedIndex >= 0) {
             emit thumbnailClicked(selectedIndex);
         }
@@ -863,6 +1116,15 @@ void ThumbnailWidget::resizeEvent(QResizeEvent *event)
     updateMinimumHeight();
 }
 
+void ThumbnailWidget::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    if (loadDeferred) {
+        loadDeferred = false;
+        startLoadingAllThumbnails();
+    }
+}
+
 void ThumbnailWidget::updateThumbnails()
 {
     // 这个方法现在不需要了，因为我们使用批量加载
@@ -889,47 +1151,50 @@ int ThumbnailWidget::calculateCostForPixmap(const QPixmap &pixmap) const
 
 void ThumbnailWidget::logCacheStats()
 {
-    qDebug() << "========================================";
-    qDebug() << "=== 缩略图缓存统计 ===";
-    qDebug() << "智能缓存条目数:" << smartThumbnailCache.size();
-    qDebug() << "智能缓存总成本:" << smartThumbnailCache.totalCost() / (1024.0 * 1024.0) << "MB";
-    qDebug() << "智能缓存最大容量:" << smartThumbnailCache.maxCost() / (1024.0 * 1024.0) << "MB";
-    qDebug() << "智能缓存使用率:" << QString::number(smartThumbnailCache.totalCost() * 100.0 /
+    // 统计要加锁遍历整个静态缓存，没开调试日志时直接跳过（setImageList 每次切换目录都会调用）
+    if (!lcThumbnail().isDebugEnabled()) return;
+
+    qCDebug(lcThumbnail) << "========================================";
+    qCDebug(lcThumbnail) << "=== 缩略图缓存统计 ===";
+    qCDebug(lcThumbnail) << "智能缓存条目数:" << smartThumbnailCache.size();
+    qCDebug(lcThumbnail) << "智能缓存总成本:" << smartThumbnailCache.totalCost() / (1024.0 * 1024.0) << "MB";
+    qCDebug(lcThumbnail) << "智能缓存最大容量:" << smartThumbnailCache.maxCost() / (1024.0 * 1024.0) << "MB";
+    qCDebug(lcThumbnail) << "智能缓存使用率:" << QString::number(smartThumbnailCache.totalCost() * 100.0 /
                                                          smartThumbnailCache.maxCost(), 'f', 1) << "%";
 
     // 静态缓存统计
     QMutexLocker locker(&cacheMutex);
-    qDebug() << "静态缓存条目数:" << thumbnailCache.size();
+    qCDebug(lcThumbnail) << "静态缓存条目数:" << thumbnailCache.size();
 
     // 计算静态缓存估算内存（粗略）
     int staticCacheMemory = 0;
     for (auto it = thumbnailCache.begin(); it != thumbnailCache.end(); ++it) {
         staticCacheMemory += it->width() * it->height() * 4;
     }
-    qDebug() << "静态缓存估算内存:" << staticCacheMemory / (1024.0 * 1024.0) << "MB";
+    qCDebug(lcThumbnail) << "静态缓存估算内存:" << staticCacheMemory / (1024.0 * 1024.0) << "MB";
 
     // 加载统计
-    qDebug() << "已加载数量:" << loadedCount << "/" << totalCount;
-    qDebug() << "加载进度:" << QString::number(loadedCount * 100.0 / totalCount, 'f', 1) << "%";
+    qCDebug(lcThumbnail) << "已加载数量:" << loadedCount << "/" << totalCount;
+    qCDebug(lcThumbnail) << "加载进度:" << QString::number(loadedCount * 100.0 / totalCount, 'f', 1) << "%";
 
     // 失败统计
-    qDebug() << "失败缩略图数量:" << failedThumbnails.size();
-    if (!failedThumbnails.isEmpty() && failedThumbnails.size() <= 10) {
-        qDebug() << "失败列表:";
-        for (const QString& key : failedThumbnails) {
-            qDebug() << "  -" << key;
+    qCDebug(lcThumbnail) << "失败缩略图数量:" << failures.size();
+    if (!failures.isEmpty() && failures.size() <= 10) {
+        qCDebug(lcThumbnail) << "失败列表:";
+        for (auto it = failures.cbegin(); it != failures.cend(); ++it) {
+            qCDebug(lcThumbnail) << "  -" << it.key() << it->error << "尝试次数:" << it->attempts;
         }
     }
 
     // 性能配置
-    qDebug() << "=== 性能配置 ===";
-    qDebug() << "最大缓存内存:" << perfConfig.maxCacheMemoryMB << "MB";
-    qDebug() << "批量加载大小:" << perfConfig.batchLoadSize;
-    qDebug() << "批量加载延迟:" << perfConfig.batchLoadDelay << "ms";
-    //qDebug() << "预加载范围:" << preloadRange;
-    qDebug() << "懒加载模式:" << (perfConfig.enableLazyLoading ? "启用" : "禁用");
-    qDebug() << "加载状态:" << (isLoading ? "加载中" : "空闲");
-    qDebug() << "========================================";
+    qCDebug(lcThumbnail) << "=== 性能配置 ===";
+    qCDebug(lcThumbnail) << "最大缓存内存:" << perfConfig.maxCacheMemoryMB << "MB";
+    qCDebug(lcThumbnail) << "批量加载大小:" << perfConfig.batchLoadSize;
+    qCDebug(lcThumbnail) << "批量加载延迟:" << perfConfig.batchLoadDelay << "ms";
+    //qCDebug(lcThumbnail) << "预加载范围:" << preloadRange;
+    qCDebug(lcThumbnail) << "懒加载模式:" << (perfConfig.enableLazyLoading ? "启用" : "禁用");
+    qCDebug(lcThumbnail) << "加载状态:" << (isLoading ? "加载中" : "空闲");
+    qCDebug(lcThumbnail) << "========================================";
 }
 
 // 设置缓存大小（MB）
@@ -944,7 +1209,7 @@ void ThumbnailWidget::setCacheSize(int maxSizeMB)
     // 可选：清理超出部分
     smartThumbnailCache.clear();
 
-    qDebug() << "缩略图缓存大小设置为:" << maxSizeMB << "MB";
+    qCDebug(lcThumbnail) << "缩略图缓存大小设置为:" << maxSizeMB << "MB";
 }
 
 // 优化获取缓存方法
@@ -976,7 +1241,7 @@ QPixmap ThumbnailWidget::getCachedThumbnail(const QString &cacheKey)
 
 void ThumbnailWidget::mousePressEvent(QMouseEvent *event)
 {
-    qDebug() << "ThumbnailWidget 鼠标按下，位置:" << event->pos();
+    qCDebug(lcThumbnail) << "ThumbnailWidget 鼠标按下，位置:" << event->pos();
 
     if (event->button() == Qt::LeftButton) {
         selectThumbnailAtPosition(event->pos());
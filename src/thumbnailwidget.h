@@ -2,7 +2,6 @@
 #ifndef THUMBNAILWIDGET_H
 #define THUMBNAILWIDGET_H
 
-#include "qfuturewatcher.h"
 #include <QWidget>
 #include <QPixmap>
 #include <QDir>
@@ -12,6 +11,14 @@
 #include <QCache>
 #include <QTimer>
 #include <QSet>
+#include <QHash>
+#include <QMultiMap>
+#include <QElapsedTimer>
+#include <memory>
+#include "mpscqueue.h"
+#include "cancellationtoken.h"
+#include "thumbnailloader.h"
+#include "threadpools.h"
 
 class ImageWidget;  // 前向声明
 
@@ -31,15 +38,22 @@ public:
     static void clearThumbnailCacheForImage(const QString &imagePath);
     void stopLoading();
 
+    // 增量更新（目录监视使用）：只处理变化的条目，保持选中项和滚动位置
+    void insertImage(int index, const QString &fileName);
+    void removeImage(int index);
+    void renameImage(int oldIndex, int newIndex, const QString &newFileName);
+    void reloadImage(int index);
+    // 只改变顺序（切换排序方式），缓存和加载队列保持不变
+    void setImageOrder(const QStringList &list);
+
     // 性能优化方法
     void setThumbnailSize(const QSize &size);
     void setCacheSize(int maxSizeMB);
 
     // 诊断方法
     void diagnoseLoadingIssues();
-    void logThumbnailStatus();
+    // 手动重试：清零所有失败条目的重试次数并立即重新加载
     void retryFailedThumbnails();
-    void forceReloadAll();
 
 signals:
     void thumbnailClicked(int index);
@@ -53,9 +67,12 @@ protected:
     void mouseDoubleClickEvent(QMouseEvent *event) override;
     void keyPressEvent(QKeyEvent *event) override;
     void resizeEvent(QResizeEvent *event) override;
+    void showEvent(QShowEvent *event) override;
 
 private slots:
     void processBatchLoad();
+    void drainThumbnailResults();
+    void retryDueThumbnails();
 
 private:
     // 核心方法
@@ -67,10 +84,11 @@ private:
 
     // 性能优化方法
     void startLoadingAllThumbnails();
-    void loadThumbnailsBatch(const QStringList &fileNames);
-    QPixmap loadSingleThumbnail(const QString &fileName);
-    QPixmap loadImageFileFast(const QString &filePath);
+    void enqueueThumbnailLoad(const QString &fileName);
+    void loadThumbnailsBatch(const QStringList &fileNames,
+                             int priority = ThreadPools::PriorityBackground);
     int calculateItemsPerRow() const;
+    QRect itemRect(int index) const;
     void drawThumbnailItem(QPainter &painter, int index, int x, int y,
                            const QString &fileName, const QPixmap &thumbnail, bool isArchive);
     QString getCacheKey(const QString &fileName) const;
@@ -80,8 +98,6 @@ private:
     // 缓存管理
     void cleanupOldCache();
     QPixmap getCachedThumbnail(const QString &cacheKey);
-    QPixmap scaleThumbnailWithAspectRatio(const QPixmap &original) const;
-    QImage scaleImageWithAspectRatio(const QImage &original) const;
 
     // 基础成员
     ImageWidget *imageWidget;
@@ -94,8 +110,11 @@ private:
     // 加载相关
     int loadedCount;
     int totalCount;
-    QFutureWatcher<QPixmap> *futureWatcher;
     bool isLoading;
+    // 列表设置时部件不可见（单图视图、窗口尚未显示）：整体加载推迟到第一次显示
+    bool loadDeferred = false;
+    // 切换目录时前进，之前提交的任务在各阶段之间检查后立即退出
+    GenerationCounter loadGeneration;
 
     // 静态缓存 - 保持向后兼容
     static QMap<QString, QPixmap> thumbnailCache;
@@ -108,27 +127,72 @@ private:
 
     // 批量加载系统
     QTimer batchLoadTimer;
-    QSet<QString> pendingLoadRequests;
+    QSet<QString> pendingLoadRequests;   // 已提交、结果尚未取出的文件
+    QSet<QString> urgentLoadRequests;    // 其中以"可见"优先级提交的文件
+    QSet<QString> uncountedLoadRequests; // 只以"可见"优先级提交、尚未计入进度的文件
     QStringList allFilesToLoad;
     int currentBatchIndex;
 
+    // 工作线程的加载结果：无锁入队，GUI 线程按帧（约 16ms）统一取出，
+    // 只重绘实际到达且可见的缩略图区域
+    struct ThumbnailResult {
+        QString fileName;
+        int indexHint = -1;      // 提交时在 imageList 中的位置，取出时校验
+        quint64 generation = 0;
+        ThumbnailLoader::Result load;
+    };
+    // 共享所有权：工作线程不持有 this，窗口销毁后仍可安全入队
+    std::shared_ptr<MpscQueue<ThumbnailResult>> resultQueue;
+    QTimer resultDrainTimer;
+    int pendingResultCount;      // 已提交但尚未取出的结果数（只在 GUI 线程修改）
+    void startResultDrain(int submittedCount);
+
+    struct ThumbnailJob {
+        QString fileName;
+        QString path;            // 绝对路径或 "压缩包|内部路径"
+        int indexHint = -1;
+    };
+    // 读取放到 I/O 池，解码和缩放放到 CPU 池；idle 为 true 时整个任务在空闲池执行
+    void submitThumbnailJob(const ThumbnailJob &job, int priority, bool idle = false);
+    // 同一压缩包的条目只遍历解压一次（I/O 池），逐个交给 CPU 池解码
+    void submitArchiveJobs(const QString &archivePath, const QVector<ThumbnailJob> &jobs, int priority);
+    // hold 随解码任务一起释放（执行完或被线程池丢弃）
+    static void decodeOnCpuPool(const std::shared_ptr<MpscQueue<ThumbnailResult>> &queue,
+                                const CancellationToken &token, const QSize &size,
+                                const QString &path, const QByteArray &data, int priority,
+                                ThumbnailResult result, const std::shared_ptr<void> &hold = nullptr);
+
     // 性能配置
     // thumbnailwidget.h
 
     struct PerformanceConfig {
         int maxCacheMemoryMB = 100;           // 最大缓存内存 100MB (改为MB单位)
-        int batchLoadSize = 1;                // 每次批量加载1个
-        int batchLoadDelay = 150;              // 批次间延迟150ms
+        int batchLoadSize = 16;               // 每次提交16个（并发由线程池限制）
+        int batchLoadDelay = 50;              // 批次间延迟50ms
         int preloadRange = 1;                 // 预加载前后1个
         bool enableLazyLoading = true;        // 启用懒加载
         bool enablePriorityLoading = true;    // 启用优先级加载
     };
     PerformanceConfig perfConfig;
 
-    // 诊断相关成员
-    QSet<QString> failedThumbnails;
-    QMap<QString, QString> loadingErrors;
-    QTimer *diagnosticTimer;
+    // 失败状态：只在加载结果到达时更新，不做周期性扫描。
+    // 每个条目有重试预算，按指数退避在空闲池重试，用完后保持失败直到文件变化或手动重试
+    struct FailureState {
+        QString fileName;
+        QString error;
+        int attempts = 0;        // 已失败次数
+        qint64 retryAtMs = -1;   // 计划重试的时间（failureClock），-1 表示不再自动重试
+    };
+    QHash<QString, FailureState> failures;          // 缓存键 -> 失败状态
+    QMultiMap<qint64, QString> retrySchedule;       // 重试时间 -> 缓存键，最早的在前
+    QElapsedTimer failureClock;
+    QTimer retryTimer;
+    void recordFailure(const QString &cacheKey, const QString &fileName, const QString &error);
+    void forgetFailure(const QString &cacheKey);
+    void clearFailures();
+    void scheduleRetryTimer();
+    void resubmitFailed(const QString &cacheKey, const QString &fileName);
+
     int calculateCostForPixmap(const QPixmap &pixmap) const;
     void logCacheStats();
     void finishLoading();
@@ -0,0 +1,180 @@
+// trace.cpp
+#include "trace.h"
+#include <QCoreApplication>
+#include <QSaveFile>
+#include <QThread>
+#include <QMutex>
+#include <QVector>
+#include <QDebug>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace Trace
+{
+namespace Detail
+{
+std::atomic<bool> enabled{false};
+}
+
+namespace
+{
+
+struct Event {
+    const char *name;
+    const char *category;
+    qint64 startNs;
+    qint64 durationNs;
+};
+
+// 每个线程一个环形缓冲区：只有所属线程写入，写满后覆盖最旧的事件
+struct ThreadBuffer {
+    static constexpr quint64 kCapacity = 1u << 15;   // 32768 个事件，约 1 MB
+
+    std::vector<Event> events = std::vector<Event>(kCapacity);
+    std::atomic<quint64> head{0};
+    int threadId = 0;
+    QString threadName;
+};
+
+// 所有线程缓冲区的登记表；缓冲区在线程退出后仍保留，导出时才能看到线程池里已回收的线程
+struct Registry {
+    QMutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+};
+
+Registry &registry()
+{
+    static Registry *instance = new Registry;   // 不析构：退出阶段的线程仍可能写入
+    return *instance;
+}
+
+ThreadBuffer *currentBuffer()
+{
+    thread_local ThreadBuffer *buffer = nullptr;
+    if (buffer) return buffer;
+
+    auto created = std::make_unique<ThreadBuffer>();
+    QThread *thread = QThread::currentThread();
+    created->threadName = thread->objectName();
+
+    Registry &reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    created->threadId = int(reg.buffers.size()) + 1;
+    if (created->threadName.isEmpty()) {
+        const bool isMain = QCoreApplication::instance()
+                            && thread == QCoreApplication::instance()->thread();
+        created->threadName = isMain ? QString("Main") : QString("Thread %1").arg(created->threadId);
+    }
+    buffer = created.get();
+    reg.buffers.push_back(std::move(created));
+    return buffer;
+}
+
+const qint64 kProcessStart = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                 std::chrono::steady_clock::now().time_since_epoch()).count();
+
+QByteArray jsonString(const QString &value)
+{
+    QByteArray out = "\"";
+    for (QChar c : value) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += char(c.unicode());
+        } else if (c.unicode() < 0x20) {
+            out += QString("\\u%1").arg(c.unicode(), 4, 16, QChar('0')).toLatin1();
+        } else {
+            out += QString(c).toUtf8();
+        }
+    }
+    out += '"';
+    return out;
+}
+
+} // namespace
+
+QString enableFromArguments(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            setEnabled(true);
+            return QString::fromLocal8Bit(argv[i + 1]);
+        }
+        if (std::strncmp(argv[i], "--trace=", 8) == 0) {
+            setEnabled(true);
+            return QString::fromLocal8Bit(argv[i] + 8);
+        }
+    }
+    return QString();
+}
+
+void setEnabled(bool enabled)
+{
+    Detail::enabled.store(enabled, std::memory_order_relaxed);
+}
+
+qint64 now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count() - kProcessStart;
+}
+
+void record(const char *name, const char *category, qint64 startNs, qint64 durationNs)
+{
+    ThreadBuffer *buffer = currentBuffer();
+    const quint64 head = buffer->head.load(std::memory_order_relaxed);
+    buffer->events[head % ThreadBuffer::kCapacity] = {name, category, startNs, durationNs};
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+bool writeChromeJson(const QString &filePath)
+{
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "无法写入 trace 文件:" << filePath;
+        return false;
+    }
+
+    const qint64 pid = QCoreApplication::applicationPid();
+    QByteArray out;
+    out.reserve(1 << 20);
+    out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    bool first = true;
+    int eventCount = 0;
+    Registry &reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    for (const auto &buffer : reg.buffers) {
+        if (!first) out += ",\n";
+        first = false;
+        out += QString("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%1,\"tid\":%2,\"args\":{\"name\":")
+                   .arg(pid).arg(buffer->threadId).toUtf8();
+        out += jsonString(buffer->threadName);
+        out += "}}";
+
+        const quint64 head = buffer->head.load(std::memory_order_acquire);
+        const quint64 begin = head > ThreadBuffer::kCapacity ? head - ThreadBuffer::kCapacity : 0;
+        for (quint64 i = begin; i < head; ++i) {
+            const Event &event = buffer->events[i % ThreadBuffer::kCapacity];
+            // Chrome trace 的时间单位是微秒
+            out += QString(",\n{\"name\":\"%1\",\"cat\":\"%2\",\"ph\":\"X\",\"ts\":%3,\"dur\":%4,\"pid\":%5,\"tid\":%6}")
+                       .arg(QLatin1String(event.name))
+                       .arg(QLatin1String(event.category))
+                       .arg(event.startNs / 1000.0, 0, 'f', 3)
+                       .arg(event.durationNs / 1000.0, 0, 'f', 3)
+                       .arg(pid)
+                       .arg(buffer->threadId)
+                       .toUtf8();
+            ++eventCount;
+        }
+    }
+    out += "\n]}\n";
+
+    file.write(out);
+    if (!file.commit()) return false;
+    qInfo() << "trace 已写入:" << filePath << "事件数:" << eventCount;
+    return true;
+}
+
+} // namespace Trace
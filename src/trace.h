@@ -0,0 +1,77 @@
+// trace.h
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+
+// 轻量级性能跟踪：RAII 区间记录开始时间和耗时（单调时钟，纳秒），
+// 写入每个线程自己的环形缓冲区（单写者，无锁），退出时导出为 Chrome trace JSON，
+// 可直接在 chrome://tracing 或 Perfetto 中打开。
+//
+//   void ArchiveHandler::extractFile(...)
+//   {
+//       PV_TRACE_SCOPE("extract");
+//       ...
+//   }
+//
+// 未启用时每个区间只有一次原子读取的开销。名称和分类必须是字符串字面量（只保存指针）。
+namespace Trace
+{
+    // 从命令行取出 --trace <文件> / --trace=<文件> 并启用跟踪，返回输出路径（未指定时为空）
+    QString enableFromArguments(int argc, char *argv[]);
+
+    void setEnabled(bool enabled);
+    inline bool isEnabled();
+
+    // 单调时钟，纳秒
+    qint64 now();
+
+    // 由 TraceSpan 调用：记录一个完整区间
+    void record(const char *name, const char *category, qint64 startNs, qint64 durationNs);
+
+    // 导出所有线程的缓冲区（应在后台任务结束后调用）
+    bool writeChromeJson(const QString &filePath);
+
+    namespace Detail
+    {
+        extern std::atomic<bool> enabled;
+    }
+
+    inline bool isEnabled()
+    {
+        return Detail::enabled.load(std::memory_order_relaxed);
+    }
+}
+
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char *name, const char *category = "app")
+        : m_name(name), m_category(category), m_start(Trace::isEnabled() ? Trace::now() : -1)
+    {
+    }
+
+    ~TraceSpan()
+    {
+        if (m_start >= 0) {
+            Trace::record(m_name, m_category, m_start, Trace::now() - m_start);
+        }
+    }
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+    const char *m_name;
+    const char *m_category;
+    qint64 m_start;
+};
+
+#define PV_TRACE_CONCAT_INNER(a, b) a##b
+#define PV_TRACE_CONCAT(a, b) PV_TRACE_CONCAT_INNER(a, b)
+#define PV_TRACE_SCOPE(name) TraceSpan PV_TRACE_CONCAT(pvTraceSpan_, __LINE__)(name)
+#define PV_TRACE_SCOPE_CAT(name, category) TraceSpan PV_TRACE_CONCAT(pvTraceSpan_, __LINE__)(name, category)
+
+#endif // TRACE_H
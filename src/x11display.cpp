@@ -0,0 +1,44 @@
+// x11display.cpp
+#include "x11display.h"
+
+#ifdef Q_OS_LINUX
+#include <QGuiApplication>
+#include <QDebug>
+
+namespace
+{
+Display *s_fallbackDisplay = nullptr;
+
+void closeFallbackDisplay()
+{
+    if (s_fallbackDisplay) {
+        XCloseDisplay(s_fallbackDisplay);
+        s_fallbackDisplay = nullptr;
+    }
+}
+}
+
+Display *X11Display::get()
+{
+    static const bool isXcb = QGuiApplication::platformName().contains("xcb");
+    if (!isXcb) return nullptr;
+
+    if (auto *x11App = qApp->nativeInterface<QNativeInterface::QX11Application>()) {
+        if (Display *display = x11App->display()) {
+            return display;
+        }
+    }
+
+    static bool fallbackOpened = false;
+    if (!fallbackOpened) {
+        fallbackOpened = true;
+        s_fallbackDisplay = XOpenDisplay(nullptr);
+        if (s_fallbackDisplay) {
+            qAddPostRoutine(closeFallbackDisplay);
+        } else {
+            qWarning() << "无法打开 X11 显示连接";
+        }
+    }
+    return s_fallbackDisplay;
+}
+#endif
@@ -0,0 +1,20 @@
+// x11display.h
+#ifndef X11DISPLAY_H
+#define X11DISPLAY_H
+
+#include <QtGlobal>
+
+#ifdef Q_OS_LINUX
+#include <X11/Xlib.h>
+
+// 与 Qt 共用的 X11 连接：通过原生接口取得 Qt 自己的 Display，
+// 不再为每次形状更新单独 XOpenDisplay/XCloseDisplay（每次都是一次完整的连接握手）。
+// Qt 未启用 Xlib 支持时退回到进程内唯一的一条长连接。
+namespace X11Display
+{
+    // 非 xcb 平台返回 nullptr。返回的连接由 Qt 或本模块管理，调用方不要关闭
+    Display *get();
+}
+#endif
+
+#endif // X11DISPLAY_H